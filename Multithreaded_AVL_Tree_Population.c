@@ -24,6 +24,33 @@
      - Descrição: Melhoria na eficiência do algoritmo empregação do uso de mutex para exclusão mutúa
      - Autor: Pablo Oliveira
 
+    - Versão 1.4
+     - Descrição: Log de escrita antecipada (WAL) opcional com group commit. As operações de inserção e remoção são registradas em
+                  buffers por thread e uma thread escritora grava cada lote com um único write + fdatasync. A recuperação aplica
+                  o log sobre o último snapshot da árvore.
+     - Autor: Pablo Oliveira
+
+    - Versão 1.5
+     - Descrição: Ingestão de chaves a partir de arquivos ou da entrada padrão em um pipeline de estágios (leitura em blocos grandes,
+                  parsing paralelo em texto ou binário, ordenação opcional dos lotes e inserção em lote), ligados por filas limitadas.
+     - Autor: Pablo Oliveira
+
+    - Versão 1.6
+     - Descrição: Inserção e remoção com dedo (finger). Cada thread guarda o caminho da última operação e a próxima busca parte do
+                  ancestral mais profundo que cobre a chave. As threads aplicam suas chaves em lotes ordenados, nos quais o dedo
+                  permanece válido e a busca para chaves sequenciais e agrupadas é O(1) amortizada.
+     - Autor: Pablo Oliveira
+
+    - Versão 1.7
+     - Descrição: Cache opcional de chaves quentes, associativo por conjuntos, para consultas repetidas de pertinência, sucessor e
+                  predecessor. As leituras não adquirem o mutex e as inserções e remoções invalidam as entradas afetadas.
+     - Autor: Pablo Oliveira
+
+    - Versão 1.8
+     - Descrição: Liberação da árvore ao final do programa, que antes apenas atribuía NULL à raiz. A árvore é dividida em subárvores
+                  liberadas em paralelo sem recursão, e a destruição pode executar em segundo plano enquanto uma nova raiz é usada.
+     - Autor: Pablo Oliveira
+
 
     Descrição dos testes:
         Os testes tem como objetivo analisar a escalabilidade e a adaptabilidade do código a mudanças na carga de trabalho
@@ -91,6 +118,13 @@
 #include <time.h>
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 
     /
         *Definição de variáveis para teste na main
@@ -103,6 +137,42 @@
         int NUM_ELEMENTOS_ARVORE_PARA_REMOVER = 1;
 / < Número de elementos a serem removidos na árvore * /
 
+/*
+ * Quantidade de chaves que cada thread de inserção ou remoção agrupa, ordena e aplica com uma
+ * única aquisição do mutex. Dentro de um lote nenhuma outra thread modifica a árvore, então o
+ * dedo da thread continua válido de uma chave para a seguinte.
+ */
+int TAMANHO_LOTE_THREAD = 64;
+
+/*
+ * Configuração do log de escrita antecipada (WAL).
+ * Com WAL_HABILITADO igual a false a árvore opera apenas em memória.
+ */
+bool WAL_HABILITADO = false;                     // Ativa o WAL e a recuperação na inicialização
+int WAL_TAMANHO_LOTE = 4096;                     // Registros por buffer de thread que disparam um commit
+int WAL_LATENCIA_COMMIT_US = 2000;               // Tempo máximo de espera da thread escritora antes de um commit
+const char *WAL_CAMINHO_LOG = "avl.wal";         // Arquivo do log
+const char *WAL_CAMINHO_SNAPSHOT = "avl.snapshot"; // Arquivo do snapshot da árvore
+
+/*
+ * Configuração da ingestão de chaves a partir de arquivo.
+ * Com INGESTAO_ARQUIVO igual a NULL as chaves são geradas aleatoriamente pelas threads de inserção.
+ */
+const char *INGESTAO_ARQUIVO = NULL;   // Arquivo de chaves, ou "-" para a entrada padrão (também aceito como argumento do programa)
+bool INGESTAO_BINARIA = false;         // Chaves como int32 nativos em vez de texto
+bool INGESTAO_ORDENAR_LOTES = true;    // Ordena cada lote antes da inserção
+int INGESTAO_TAMANHO_BLOCO = 1 << 20;  // Bytes lidos por bloco
+int INGESTAO_THREADS_PARSER = 2;       // Threads de parsing
+int INGESTAO_PROFUNDIDADE_FILA = 4;    // Capacidade das filas entre os estágios
+
+/*
+ * Configuração do cache de chaves quentes para consultas de sucessor e predecessor.
+ */
+bool CACHE_HABILITADO = false;   // Ativa o cache e a medição de consultas concentradas
+int CACHE_CONJUNTOS = 256;       // Conjuntos do cache, cada um com CACHE_VIAS entradas
+int CACHE_CONSULTAS = 1000000;   // Consultas por thread na medição
+int CACHE_CHAVES_QUENTES = 64;   // Chaves que recebem 90% das consultas na medição
+
         /
         *Definição da estrutura de dados AvlNode.
              *Essa definição permite referenciar a própria estrutura antes de sua implementação completa.
@@ -117,6 +187,253 @@ struct AvlNode
     int altura;
 };
 
+/*
+ * Altura máxima suportada pelo caminho de um dedo. Uma árvore AVL com n nós tem altura
+ * menor que 1,45 * log2(n + 2), o que fica abaixo de 64 para qualquer quantidade de nós int.
+ */
+#define ALTURA_MAXIMA_AVL 64
+
+/*
+ * Dedo (finger) para inserções e remoções localizadas.
+ * Guarda o caminho da última operação como os endereços dos ponteiros percorridos a partir
+ * da raiz, junto com o intervalo de chaves que cabe em cada subárvore do caminho.
+ * O dedo só é válido enquanto a versão da árvore não mudar por outra operação.
+ */
+typedef struct DedoAvl
+{
+    AvlNode **caminho[ALTURA_MAXIMA_AVL]; // Endereços dos ponteiros percorridos a partir da raiz
+    long long minimo[ALTURA_MAXIMA_AVL];  // Limite inferior (exclusivo) das chaves de cada subárvore
+    long long maximo[ALTURA_MAXIMA_AVL];  // Limite superior (exclusivo) das chaves de cada subárvore
+    int profundidade;                     // Quantidade de níveis válidos do caminho
+    unsigned long versao;                 // Versão da árvore quando o caminho foi registrado
+} DedoAvl;
+
+/*
+ * Tipos de operação registrados no WAL.
+ */
+#define WAL_OP_INSERIR 1
+#define WAL_OP_REMOVER 2
+#define WAL_OP_LIMPAR 3 // A árvore inteira foi descartada; a recuperação ignora o que vem antes
+
+/*
+ * Registro do WAL mantido em memória nos buffers de cada thread.
+ * O número de sequência define a ordem global das operações na árvore.
+ */
+typedef struct RegistroWal
+{
+    long long seq;           // Ordem da operação, atribuída com o mutex da árvore adquirido
+    int chave;               // Elemento inserido ou removido
+    unsigned char operacao;  // WAL_OP_INSERIR, WAL_OP_REMOVER ou WAL_OP_LIMPAR
+} RegistroWal;
+
+/*
+ * Registro do WAL como gravado em disco (8 bytes).
+ * O byte de verificação permite descartar um registro parcialmente gravado no fim do log.
+ */
+typedef struct RegistroWalDisco
+{
+    int32_t chave;
+    uint8_t operacao;
+    uint8_t verificacao;
+    uint8_t reservado[2];
+} RegistroWalDisco;
+
+/*
+ * Buffer de registros de uma thread. A thread escritora troca o vetor ativo pelo
+ * vetor reserva a cada commit, de forma que a thread continua registrando enquanto o lote é gravado.
+ */
+typedef struct BufferWal
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t espaco_livre; // Sinalizado quando a thread escritora esvazia o buffer
+    RegistroWal *registros;      // Vetor ativo, onde a thread registra as operações
+    RegistroWal *reserva;        // Vetor trocado com o ativo a cada commit
+    int quantidade;              // Registros no vetor ativo
+} BufferWal;
+
+/*
+ * Estado do log de escrita antecipada com group commit.
+ */
+typedef struct Wal
+{
+    int fd;                           // Descritor do arquivo de log
+    BufferWal *buffers;               // Um buffer por thread de atualização
+    int num_buffers;
+    int tamanho_lote;                 // Registros por buffer que disparam um commit antecipado
+    int latencia_us;                  // Espera máxima entre commits
+    long long proxima_seq;            // Protegido pelo mutex da árvore
+    long long seq_duravel;            // Todas as operações com seq menor já estão em disco
+    bool lote_pronto;                 // Algum buffer atingiu o tamanho do lote
+    bool sincronizar;                 // Há uma thread aguardando a durabilidade do log
+    bool encerrar;
+    pthread_mutex_t mutex;            // Protege os campos de controle acima
+    pthread_mutex_t mutex_arquivo;    // Serializa gravações e truncamentos do arquivo de log
+    pthread_cond_t trabalho;          // Acorda a thread escritora
+    pthread_cond_t duravel;           // Sinalizado a cada commit concluído
+    RegistroWalDisco *lote_disco;     // Lote intercalado por seq, gravado com um único write
+    int *quantidades;                 // Quantidade de registros retirada de cada buffer no commit atual
+    int *posicoes;                    // Posição de leitura em cada buffer durante a intercalação
+    long long total_registros;        // Estatísticas: registros gravados
+    long long total_lotes;            // Estatísticas: commits (write + fdatasync) realizados
+    pthread_t escritor;
+} Wal;
+
+/*
+ * Resultado de uma consulta de vizinhos: se o elemento está na árvore e os valores do
+ * predecessor e do sucessor, se existirem.
+ */
+typedef struct ResultadoVizinhos
+{
+    bool presente;        // O elemento está na árvore
+    int predecessor;      // Maior elemento menor que a chave
+    int sucessor;         // Menor elemento maior que a chave
+    bool tem_predecessor;
+    bool tem_sucessor;
+} ResultadoVizinhos;
+
+/*
+ * Configuração do cache de chaves quentes: quantidade de vias por conjunto, estado das entradas
+ * e níveis de épocas usados na invalidação.
+ */
+#define CACHE_VIAS 3
+#define CACHE_VALIDA 1
+#define CACHE_PRESENTE 2
+#define CACHE_TEM_PREDECESSOR 4
+#define CACHE_TEM_SUCESSOR 8
+#define CACHE_NIVEL_DESLOCAMENTO 4 // O nível da época ocupa os bits 4 a 6 do estado
+#define CACHE_NIVEIS 4             // Níveis com faixas de 2^4, 2^10, 2^16 e 2^22 chaves, além da época global
+#define CACHE_FAIXAS_POR_NIVEL 1024
+
+/*
+ * Entrada do cache de chaves quentes (20 bytes). Os campos são lidos sem o mutex da árvore, por
+ * isso são atômicos e acessados com operações relaxed dentro do seqlock do conjunto.
+ */
+typedef struct EntradaCache
+{
+    atomic_int chave;
+    atomic_int predecessor;
+    atomic_int sucessor;
+    atomic_uint epoca;  // Soma das épocas que cobriam [predecessor, sucessor] no preenchimento
+    atomic_uchar estado; // Combinação de CACHE_VALIDA, CACHE_PRESENTE, CACHE_TEM_* e o nível da época
+} EntradaCache;
+
+/*
+ * Conjunto do cache, ocupando exatamente uma linha de cache de 64 bytes.
+ * O contador de sequência funciona como um seqlock: é ímpar enquanto o conjunto está sendo
+ * alterado, e um leitor que observa valores diferentes antes e depois da leitura tenta de novo.
+ */
+typedef struct ConjuntoCache
+{
+    _Alignas(64) atomic_uint seq;
+    EntradaCache vias[CACHE_VIAS];
+} ConjuntoCache;
+
+_Static_assert(sizeof(ConjuntoCache) == 64, "ConjuntoCache deve ocupar uma linha de cache");
+
+/*
+ * Cache associativo por conjuntos para consultas repetidas de pertinência, sucessor e predecessor.
+ * Leituras não adquirem o mutex da árvore. Preenchimentos e invalidações são feitos com o mutex
+ * da árvore adquirido, o que os serializa entre si.
+ *
+ * A invalidação não percorre as entradas: o espaço de chaves é dividido em faixas de vários
+ * tamanhos, cada uma com uma época, e uma atualização em x incrementa apenas a época da faixa
+ * de x em cada nível e a época global. Uma entrada guarda a soma das épocas das faixas, no nível
+ * mais fino em que no máximo duas faixas cobrem [predecessor, sucessor], e só é aceita se a soma
+ * não mudou. Como o resultado de uma entrada só muda por uma atualização dentro desse intervalo,
+ * nenhum acerto é obsoleto; faixas que colidem na tabela causam apenas faltas a mais.
+ */
+typedef struct CacheVizinhos
+{
+    ConjuntoCache *conjuntos;
+    unsigned int mascara;                                          // Quantidade de conjuntos - 1 (potência de 2)
+    atomic_uint epocas[CACHE_NIVEIS][CACHE_FAIXAS_POR_NIVEL];      // Épocas das faixas de chaves de cada nível
+    atomic_uint epoca_global;                                      // Incrementada por toda atualização
+    atomic_ullong consultas;     // Estatísticas: consultas realizadas
+    atomic_ullong acertos;       // Estatísticas: consultas respondidas pelo cache
+    atomic_ullong invalidacoes;  // Estatísticas: atualizações que incrementaram as épocas
+} CacheVizinhos;
+
+/*
+ * Fila limitada usada entre os estágios da ingestão.
+ * Um produtor bloqueia quando a fila está cheia, o que limita a memória em trânsito
+ * e repassa a pressão do estágio mais lento aos anteriores.
+ */
+typedef struct FilaLimitada
+{
+    void **itens;
+    int capacidade;
+    int inicio;
+    int quantidade;
+    int produtores; // Produtores ainda ativos; a fila é encerrada quando chega a zero
+    pthread_mutex_t mutex;
+    pthread_cond_t nao_cheia;
+    pthread_cond_t nao_vazia;
+} FilaLimitada;
+
+/*
+ * Bloco de bytes lido da entrada. Termina sempre em uma fronteira de chave.
+ */
+typedef struct BlocoIngestao
+{
+    char *dados;
+    size_t tamanho;
+} BlocoIngestao;
+
+/*
+ * Lote de chaves extraído de um bloco, opcionalmente ordenado.
+ */
+typedef struct LoteChaves
+{
+    int *chaves;
+    int quantidade;
+    int rejeitadas; // Chaves descartadas por estarem fora do intervalo de int
+} LoteChaves;
+
+/*
+ * Estado compartilhado pelos estágios de uma ingestão.
+ */
+typedef struct Ingestao
+{
+    int fd;                   // Entrada: arquivo ou stdin
+    bool binaria;             // Chaves como int32 nativos em vez de texto
+    bool ordenar;             // Ordena cada lote antes da inserção
+    size_t tamanho_bloco;     // Bytes lidos por bloco
+    FilaLimitada blocos;      // Leitor -> parsers
+    FilaLimitada lotes;       // Parsers -> inseridores
+    AvlNode **arvore;         // Endereço da raiz da árvore
+    pthread_mutex_t *mutex;   // Mutex que protege a árvore
+    unsigned long *versao;    // Contador de versão da árvore, usado pelos dedos
+    CacheVizinhos *cache;     // Cache de chaves quentes, ou NULL
+    Wal *wal;                 // WAL da árvore, ou NULL
+    long long bytes_lidos;    // Atualizado apenas pelo leitor
+    long long bytes_descartados; // Registro binário incompleto no fim da entrada, atualizado apenas pelo leitor
+    long long chaves_lidas;   // Protegido pelo mutex da árvore
+    long long rejeitadas;     // Protegido pelo mutex da árvore
+} Ingestao;
+
+/*
+ * Parâmetros de uma thread de estágio da ingestão.
+ */
+typedef struct EstagioIngestao
+{
+    Ingestao *ingestao;
+    int id; // Índice da thread no estágio, usado para escolher o buffer do WAL
+} EstagioIngestao;
+
+/*
+ * Estado de uma destruição de árvore em andamento.
+ */
+typedef struct DestruicaoArvore
+{
+    AvlNode *raiz;              // Árvore já desligada da raiz original
+    AvlNode **subarvores;       // Subárvores distribuídas entre as threads
+    int quantidade;             // Quantidade de subárvores
+    atomic_int proxima;         // Próxima subárvore a ser liberada
+    atomic_llong liberados;     // Nós liberados até o momento
+    int num_threads;
+    pthread_t coordenador;
+} DestruicaoArvore;
+
 /
     *Estrutura de dados para os parâmetros da thread.
          *Armazena os dados necessários para cada thread.
@@ -131,6 +448,14 @@ struct AvlNode
     / < Índice de fim para processamento * /
             pthread_mutex_t *mutex;
     / < Ponteiro para o mutex utilizado para sincronização * /
+    Wal *wal;
+    /**< Ponteiro para o WAL, NULL quando a árvore opera apenas em memória */
+    int id;
+    /**< Índice da thread, usado para escolher o seu buffer no WAL */
+    unsigned long *versao;
+    /**< Ponteiro para o contador de versão da árvore, usado pelos dedos */
+    CacheVizinhos *cache;
+    /**< Ponteiro para o cache de chaves quentes, ou NULL */
 } ThreadData;
 
 /
@@ -319,302 +644,2320 @@ int altura(AvlNode *t)
     balancear(t); // Realiza o balanceamento da árvore
 }
 
-/
-    *Função executada por uma thread para inserir elementos na árvore AVL.
-         *
-             *@param arg Um ponteiro para os dados da thread contendo a árvore,
-    o intervalo de elementos e o mutex.
-            *@ return NULL *
-        /
-        void * inserirThread(void *arg)
+/*
+ * Compara dois inteiros para o qsort.
+ */
+int compararInteiros(const void *a, const void *b)
+{
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Inicializa um dedo vazio. A primeira operação com o dedo parte da raiz.
+ *
+ * @param dedo O dedo a ser inicializado.
+ */
+void dedoIniciar(DedoAvl *dedo)
+{
+    dedo->profundidade = 0;
+    dedo->versao = 0;
+}
+
+/*
+ * Localiza no caminho do dedo o ancestral mais profundo cuja subárvore cobre a chave.
+ * Se a árvore foi modificada por outra operação desde o último uso, inclusive por outra
+ * thread, o dedo é descartado e o caminho recomeça na raiz. Ao final, o dedo termina nesse ancestral.
+ *
+ * @param dedo O dedo.
+ * @param t O endereço da raiz da árvore.
+ * @param x A chave procurada.
+ * @param versao A versão atual da árvore.
+ * @return O índice, no caminho, do ancestral que cobre a chave.
+ */
+int dedoLocalizar(DedoAvl *dedo, AvlNode **t, const int x, unsigned long versao)
 {
-    ThreadData *data = (ThreadData *)arg; // Obtém os dados da thread
-    AvlNode arvore = data->arvore;        // Ponteiro para a raiz da árvore
-    int inicio = data->inicio;            // Valor inicial do intervalo de valores a serem inseridos
-    int fim = data->fim;                  // Valor final do intervalo de valores a serem inseridos
     int i;
 
-    // Itera pelo intervalo de valores definido para a thread
-    for (i = inicio; i <= fim; i++)
+    if (dedo->profundidade == 0 || dedo->versao != versao || dedo->caminho[0] != t)
     {
-        int valor = rand() % ((fim - inicio + 1) * 10) + inicio * 10; // Gera um valor aleatório para inserção
+        dedo->caminho[0] = t;
+        dedo->minimo[0] = LLONG_MIN;
+        dedo->maximo[0] = LLONG_MAX;
+        dedo->profundidade = 1;
+        dedo->versao = versao;
+    }
 
-        pthread_mutex_lock(data->mutex);   // Lock do mutex antes da inserção
-        inserir(valor, arvore);            // Insere o valor na árvore
-        pthread_mutex_unlock(data->mutex); // Unlock do mutex após a inserção
+    // Caminho rápido para inserções após o máximo: o último nível está no ramo direito
+    // (sem limite superior) e a chave é maior que o seu limite inferior
+    i = dedo->profundidade - 1;
+    if (dedo->maximo[i] == LLONG_MAX && x > dedo->minimo[i])
+    {
+        return i;
     }
 
-    pthread_exit(NULL); // Finaliza a thread
+    // Chaves sequenciais ou agrupadas caem no último nível, ou perto dele
+    for (; i > 0; i--)
+    {
+        if (dedo->minimo[i] < x && x < dedo->maximo[i])
+        {
+            break;
+        }
+    }
+
+    dedo->profundidade = i + 1;
+    return i;
 }
 
-/
-    *Encontra o nó com o valor mínimo na árvore AVL.
-         *
-             *@param t O nó raiz da árvore onde a busca será realizada.
-                 *@ return O ponteiro para o nó com o valor mínimo,
-    ou NULL se a árvore estiver vazia.
-            * /
-        AvlNode *EncontrarMinNode(AvlNode *t)
+/*
+ * Estende o caminho do dedo a partir do seu último nível, descendo até o nó com a chave
+ * ou até o ponteiro nulo onde ela seria inserida.
+ *
+ * @param dedo O dedo, já posicionado por dedoLocalizar.
+ * @param x A chave procurada.
+ * @return O índice do último nível do caminho.
+ */
+int dedoDescer(DedoAvl *dedo, const int x)
 {
-    if (t == NULL)
+    int i = dedo->profundidade - 1;
+
+    while (*dedo->caminho[i] != NULL && (*dedo->caminho[i])->elemento != x)
     {
-        return NULL; // Retorna NULL se a árvore estiver vazia
+        AvlNode *n = *dedo->caminho[i];
+
+        if (x < n->elemento)
+        {
+            dedo->caminho[i + 1] = &n->esquerda;
+            dedo->minimo[i + 1] = dedo->minimo[i];
+            dedo->maximo[i + 1] = n->elemento;
+        }
+        else
+        {
+            dedo->caminho[i + 1] = &n->direita;
+            dedo->minimo[i + 1] = n->elemento;
+            dedo->maximo[i + 1] = dedo->maximo[i];
+        }
+        i++;
     }
 
-    if (t->esquerda == NULL)
+    dedo->profundidade = i + 1;
+    return i;
+}
+
+/*
+ * Atualiza as alturas e rebalanceia os ancestrais do caminho do dedo, do nível informado
+ * em direção à raiz, parando no primeiro que mantém a altura anterior.
+ * Uma rotação altera os níveis abaixo dela, então o dedo é encurtado até o nível rotacionado.
+ *
+ * @param dedo O dedo.
+ * @param nivel O nível mais profundo a ser atualizado.
+ */
+void dedoRebalancear(DedoAvl *dedo, int nivel)
+{
+    int i;
+
+    for (i = nivel; i >= 0; i--)
     {
-        return t; // Retorna o próprio nó se não houver filho esquerdo
-    }
+        AvlNode **s = dedo->caminho[i];
+        AvlNode *antes = *s;
+        int altura_anterior = antes->altura;
 
-    return EncontrarMinNode(t->esquerda); // Recursivamente busca o filho esquerdo até encontrar o nó com o menor valor
+        antes->altura = max(altura(antes->esquerda), altura(antes->direita)) + 1;
+        balancear(s);
+
+        if (*s != antes)
+        {
+            dedo->profundidade = i + 1; // Os níveis abaixo da rotação deixaram de existir
+        }
+        if ((*s)->altura == altura_anterior)
+        {
+            break; // Os ancestrais acima não são afetados
+        }
+    }
 }
 
-/
-    *Encontra o nó com o valor máximo na árvore AVL.
-         *
-             *@param t O nó raiz da árvore onde a busca será realizada.
-                 *@ return O ponteiro para o nó com o valor máximo,
-    ou NULL se a árvore estiver vazia.
-            * /
-        AvlNode *EncontrarMaxNode(AvlNode *t)
+/*
+ * Insere um elemento na árvore AVL partindo do dedo em vez da raiz.
+ * A busca começa no ancestral mais profundo do último caminho percorrido cujo intervalo
+ * de chaves contém o elemento. Inserções após o máximo partem direto do último nó inserido,
+ * que fica no ramo direito. Com o rebalanceamento interrompido assim que a altura se
+ * estabiliza, uma sequência de chaves ordenadas ou agrupadas aplicada com o mesmo dedo, sem
+ * modificações de outras threads entre elas, custa O(1) amortizado por inserção. Qualquer
+ * modificação de outra thread invalida o dedo e a próxima busca parte da raiz, por isso as
+ * threads agrupam suas chaves em lotes ordenados aplicados com o mutex adquirido uma única vez.
+ *
+ * @param x O elemento a ser inserido.
+ * @param t O endereço da raiz da árvore.
+ * @param dedo O dedo da thread, que passa a apontar para o elemento inserido.
+ * @param versao O contador de versão da árvore, incrementado a cada modificação. Toda
+ *               modificação da árvore que não use um dedo também deve incrementá-lo.
+ * @return true se o elemento foi inserido, false se ele já estava na árvore.
+ */
+bool inserirComDedo(const int x, AvlNode **t, DedoAvl *dedo, unsigned long *versao)
 {
-    if (t == NULL)
+    int i;
+
+    dedoLocalizar(dedo, t, x, *versao);
+    i = dedoDescer(dedo, x);
+
+    // O elemento já existe na árvore, não faz nada
+    if (*dedo->caminho[i] != NULL)
     {
-        return NULL;
+        return false;
     }
-    if (t->direita == NULL)
+
+    *dedo->caminho[i] = novoAvlNode(x, NULL, NULL, 0);
+    dedoRebalancear(dedo, i - 1);
+
+    (*versao)++;
+    dedo->versao = *versao;
+    return true;
+}
+
+/*
+ * Calcula o byte de verificação de um registro do WAL.
+ *
+ * @param chave O elemento do registro.
+ * @param operacao O tipo de operação do registro.
+ * @return O byte de verificação gravado junto ao registro.
+ */
+uint8_t walVerificacao(int32_t chave, uint8_t operacao)
+{
+    uint32_t c = (uint32_t)chave;
+    return (uint8_t)(0x5A ^ operacao ^ (c & 0xFF) ^ ((c >> 8) & 0xFF) ^ ((c >> 16) & 0xFF) ^ (c >> 24));
+}
+
+/*
+ * Registra uma operação no buffer da thread.
+ * Deve ser chamada com o mutex da árvore adquirido, logo após a operação ser aplicada,
+ * para que a ordem das sequências seja a mesma ordem em que a árvore foi modificada.
+ *
+ * @param wal O WAL onde a operação será registrada.
+ * @param id O índice da thread que realizou a operação.
+ * @param operacao WAL_OP_INSERIR, WAL_OP_REMOVER ou WAL_OP_LIMPAR.
+ * @param chave O elemento inserido ou removido (ignorado em WAL_OP_LIMPAR).
+ */
+void walRegistrar(Wal *wal, int id, unsigned char operacao, int chave)
+{
+    BufferWal *buffer = &wal->buffers[id % wal->num_buffers];
+    long long seq = wal->proxima_seq++;
+    bool lote_completo;
+
+    pthread_mutex_lock(&buffer->mutex);
+
+    // Se os dois vetores estão cheios, aguarda a thread escritora liberar espaço
+    while (buffer->quantidade >= 2 * wal->tamanho_lote)
     {
-        return t; // Retorna o próprio nó se não houver filho direito
+        pthread_cond_wait(&buffer->espaco_livre, &buffer->mutex);
     }
-    else
+
+    buffer->registros[buffer->quantidade].seq = seq;
+    buffer->registros[buffer->quantidade].chave = chave;
+    buffer->registros[buffer->quantidade].operacao = operacao;
+    buffer->quantidade++;
+    lote_completo = buffer->quantidade == wal->tamanho_lote;
+
+    pthread_mutex_unlock(&buffer->mutex);
+
+    // Antecipa o commit quando o buffer atinge o tamanho do lote
+    if (lote_completo)
     {
-        return EncontrarMaxNode(t->direita);
+        pthread_mutex_lock(&wal->mutex);
+        wal->lote_pronto = true;
+        pthread_cond_signal(&wal->trabalho);
+        pthread_mutex_unlock(&wal->mutex);
     }
 }
 
-/
-    *Remove um nó com o valor especificado da árvore AVL.
-         *
-             *@param x O valor a ser removido.
-                 *@param t O ponteiro para o nó raiz da árvore.
-                     *@param removerElemento O ponteiro para a variável onde o elemento removido será armazenado.
-                         * /
-    void removerNode(const int x, AvlNode t, int *removerElemento)
+/*
+ * Grava um bloco completo no arquivo, repetindo o write em caso de gravação parcial.
+ *
+ * @param fd O descritor do arquivo.
+ * @param dados Os bytes a serem gravados.
+ * @param tamanho A quantidade de bytes.
+ */
+void walGravarTudo(int fd, const void *dados, size_t tamanho)
 {
-    // Implementação da função removerNode partes do código do livro "Data Structures and Algorithm Analysis in C++." por Autor do Livro (página 157)
+    const char *p = (const char *)dados;
 
-    if (*t == NULL)
+    while (tamanho > 0)
     {
-        return; // Retorna se a árvore estiver vazia
+        ssize_t gravados = write(fd, p, tamanho);
+        if (gravados < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            printf("Erro ao gravar o log: %s\n", strerror(errno));
+            exit(1);
+        }
+        p += gravados;
+        tamanho -= (size_t)gravados;
     }
+}
 
-    if (x < (*t)->elemento)
+/*
+ * Realiza um group commit: retira os registros de todos os buffers, intercala-os pela
+ * sequência e grava o lote com um único write seguido de fdatasync.
+ *
+ * Os buffers são trocados com todos os seus mutexes adquiridos. Como as sequências são
+ * atribuídas com o mutex da árvore adquirido, o lote retirado é sempre um prefixo contínuo
+ * da ordem global das operações.
+ *
+ * @param wal O WAL a ser gravado.
+ * @return A quantidade de registros gravados.
+ */
+int walCommit(Wal *wal)
+{
+    int i, total = 0, n;
+    long long ultima_seq = -1;
+
+    for (i = 0; i < wal->num_buffers; i++)
     {
-        removerNode(x, &((*t)->esquerda), removerElemento); // Chama a função recursivamente para a subárvore esquerda
+        pthread_mutex_lock(&wal->buffers[i].mutex);
     }
-    else if (x > (*t)->elemento)
+    for (i = 0; i < wal->num_buffers; i++)
     {
-        removerNode(x, &((*t)->direita), removerElemento); // Chama a função recursivamente para a subárvore direita
+        BufferWal *buffer = &wal->buffers[i];
+        RegistroWal *cheio = buffer->registros;
+
+        buffer->registros = buffer->reserva; // A thread passa a registrar no vetor vazio
+        buffer->reserva = cheio;             // O vetor cheio é gravado fora do mutex
+        wal->quantidades[i] = buffer->quantidade;
+        wal->posicoes[i] = 0;
+        total += buffer->quantidade;
+        buffer->quantidade = 0;
+        pthread_cond_broadcast(&buffer->espaco_livre);
     }
-    else if ((*t)->esquerda != NULL && (*t)->direita != NULL)
+    for (i = wal->num_buffers - 1; i >= 0; i--)
     {
-        // Nó a ser removido tem dois filhos
-        AvlNode *nodeParaRemover = *t;
-        AvlNode *minNode = EncontrarMinNode(nodeParaRemover->direita);  // Encontra o nó com o menor valor na subárvore direita
-        *removerElemento = minNode->elemento;                           // Armazena o elemento a ser removido
-        (*t)->elemento = minNode->elemento;                             // Substitui o elemento do nó atual pelo elemento do nó encontrado
-        removerNode((*t)->elemento, &((*t)->direita), removerElemento); // Remove o nó encontrado recursivamente
+        pthread_mutex_unlock(&wal->buffers[i].mutex);
     }
-    else
+
+    if (total == 0)
     {
-        // Nó a ser removido tem zero ou um filho
-        AvlNode *nodeParaRemover = *t;
-        *t = ((*t)->esquerda != NULL) ? (*t)->esquerda : (*t)->direita; // Substitui o nó atual pelo seu filho (se existir)
-        *removerElemento = nodeParaRemover->elemento;                   // Armazena o elemento a ser removido
-        free(nodeParaRemover);                                          // Libera a memória do nó removido
+        return 0;
     }
 
-    // Atualiza a altura do nó pai e realiza o balanceamento, se necessário
-    if (*t != NULL)
+    // Intercala os buffers, cada um já ordenado por sequência
+    for (n = 0; n < total; n++)
     {
-        (*t)->altura = max(altura((*t)->esquerda), altura((*t)->direita)) + 1;
-        balancear(t);
-    }
-}
+        int escolhido = -1;
+        RegistroWal *r;
+
+        for (i = 0; i < wal->num_buffers; i++)
+        {
+            if (wal->posicoes[i] < wal->quantidades[i] &&
+                (escolhido < 0 || wal->buffers[i].reserva[wal->posicoes[i]].seq <
+                                      wal->buffers[escolhido].reserva[wal->posicoes[escolhido]].seq))
+            {
+                escolhido = i;
+            }
+        }
+
+        r = &wal->buffers[escolhido].reserva[wal->posicoes[escolhido]++];
+        wal->lote_disco[n].chave = r->chave;
+        wal->lote_disco[n].operacao = r->operacao;
+        wal->lote_disco[n].verificacao = walVerificacao(r->chave, r->operacao);
+        wal->lote_disco[n].reservado[0] = 0;
+        wal->lote_disco[n].reservado[1] = 0;
+        ultima_seq = r->seq;
+    }
+
+    pthread_mutex_lock(&wal->mutex_arquivo);
+    walGravarTudo(wal->fd, wal->lote_disco, (size_t)total * sizeof(RegistroWalDisco));
+    if (fdatasync(wal->fd) != 0)
+    {
+        printf("Erro ao sincronizar o log: %s\n", strerror(errno));
+        exit(1);
+    }
+    pthread_mutex_unlock(&wal->mutex_arquivo);
+
+    pthread_mutex_lock(&wal->mutex);
+    wal->seq_duravel = ultima_seq + 1;
+    wal->total_registros += total;
+    wal->total_lotes++;
+    pthread_cond_broadcast(&wal->duravel);
+    pthread_mutex_unlock(&wal->mutex);
+
+    return total;
+}
+
+/*
+ * Função executada pela thread escritora do WAL.
+ * Realiza um commit quando algum buffer completa um lote, quando há uma sincronização
+ * pendente ou quando a latência máxima de commit é atingida.
+ *
+ * @param arg Um ponteiro para o WAL.
+ * @return NULL
+ */
+void *walEscritorThread(void *arg)
+{
+    Wal *wal = (Wal *)arg;
+    bool encerrar = false;
+
+    while (!encerrar)
+    {
+        struct timespec limite;
+        clock_gettime(CLOCK_REALTIME, &limite);
+        limite.tv_nsec += (long)wal->latencia_us * 1000;
+        limite.tv_sec += limite.tv_nsec / 1000000000;
+        limite.tv_nsec %= 1000000000;
+
+        pthread_mutex_lock(&wal->mutex);
+        while (!wal->lote_pronto && !wal->sincronizar && !wal->encerrar)
+        {
+            if (pthread_cond_timedwait(&wal->trabalho, &wal->mutex, &limite) == ETIMEDOUT)
+            {
+                break;
+            }
+        }
+        wal->lote_pronto = false;
+        wal->sincronizar = false;
+        encerrar = wal->encerrar;
+        pthread_mutex_unlock(&wal->mutex);
+
+        walCommit(wal);
+    }
+
+    pthread_exit(NULL);
+}
+
+/*
+ * Sincroniza o diretório que contém um arquivo, tornando duráveis as suas criações e renomeações.
+ *
+ * @param caminho O caminho do arquivo.
+ * @return true se o diretório foi sincronizado, false caso contrário.
+ */
+bool sincronizarDiretorio(const char *caminho)
+{
+    char diretorio[4096];
+    char *barra;
+    int fd;
+
+    snprintf(diretorio, sizeof(diretorio), "%s", caminho);
+    barra = strrchr(diretorio, '/');
+    if (barra == NULL)
+    {
+        strcpy(diretorio, ".");
+    }
+    else if (barra == diretorio)
+    {
+        diretorio[1] = '\0'; // Arquivo na raiz do sistema de arquivos
+    }
+    else
+    {
+        *barra = '\0';
+    }
+
+    fd = open(diretorio, O_RDONLY | O_DIRECTORY);
+    if (fd < 0 || fsync(fd) != 0)
+    {
+        printf("Erro ao sincronizar o diretório %s: %s\n", diretorio, strerror(errno));
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+    close(fd);
+
+    return true;
+}
+
+/*
+ * Abre (ou cria) o arquivo de log e inicia a thread escritora.
+ *
+ * @param caminho O caminho do arquivo de log.
+ * @param num_buffers A quantidade de threads que registrarão operações.
+ * @param tamanho_lote Registros por buffer que disparam um commit antecipado.
+ * @param latencia_us Espera máxima, em microssegundos, entre dois commits.
+ * @return Um ponteiro para o WAL criado.
+ * @note Em caso de falha na abertura ou na alocação, a função imprime uma mensagem de erro e encerra o programa.
+ */
+Wal *walAbrir(const char *caminho, int num_buffers, int tamanho_lote, int latencia_us)
+{
+    Wal *wal = (Wal *)calloc(1, sizeof(Wal));
+    int i;
+
+    if (wal == NULL)
+    {
+        printf("Erro ao alocar memória\n");
+        exit(1);
+    }
+
+    wal->fd = open(caminho, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (wal->fd < 0)
+    {
+        printf("Erro ao abrir o log %s: %s\n", caminho, strerror(errno));
+        exit(1);
+    }
+
+    // Se o log acabou de ser criado, a sua entrada no diretório só é durável após o fsync do diretório
+    if (!sincronizarDiretorio(caminho))
+    {
+        exit(1);
+    }
+
+    wal->num_buffers = num_buffers;
+    wal->tamanho_lote = tamanho_lote;
+    wal->latencia_us = latencia_us;
+    wal->buffers = (BufferWal *)calloc((size_t)num_buffers, sizeof(BufferWal));
+    wal->quantidades = (int *)calloc((size_t)num_buffers, sizeof(int));
+    wal->posicoes = (int *)calloc((size_t)num_buffers, sizeof(int));
+    wal->lote_disco = (RegistroWalDisco *)malloc((size_t)num_buffers * 2 * tamanho_lote * sizeof(RegistroWalDisco));
+    if (wal->buffers == NULL || wal->quantidades == NULL || wal->posicoes == NULL || wal->lote_disco == NULL)
+    {
+        printf("Erro ao alocar memória\n");
+        exit(1);
+    }
+
+    for (i = 0; i < num_buffers; i++)
+    {
+        BufferWal *buffer = &wal->buffers[i];
+        buffer->registros = (RegistroWal *)malloc((size_t)2 * tamanho_lote * sizeof(RegistroWal));
+        buffer->reserva = (RegistroWal *)malloc((size_t)2 * tamanho_lote * sizeof(RegistroWal));
+        if (buffer->registros == NULL || buffer->reserva == NULL)
+        {
+            printf("Erro ao alocar memória\n");
+            exit(1);
+        }
+        pthread_mutex_init(&buffer->mutex, NULL);
+        pthread_cond_init(&buffer->espaco_livre, NULL);
+    }
+
+    pthread_mutex_init(&wal->mutex, NULL);
+    pthread_mutex_init(&wal->mutex_arquivo, NULL);
+    pthread_cond_init(&wal->trabalho, NULL);
+    pthread_cond_init(&wal->duravel, NULL);
+
+    pthread_create(&wal->escritor, NULL, walEscritorThread, (void *)wal);
+    return wal;
+}
+
+/*
+ * Aguarda até que todas as operações registradas estejam gravadas em disco.
+ * Deve ser chamada com o mutex da árvore adquirido ou sem threads de atualização ativas.
+ *
+ * @param wal O WAL a ser sincronizado.
+ */
+void walSincronizar(Wal *wal)
+{
+    pthread_mutex_lock(&wal->mutex);
+    long long alvo = wal->proxima_seq;
+
+    while (wal->seq_duravel < alvo)
+    {
+        wal->sincronizar = true;
+        pthread_cond_signal(&wal->trabalho);
+        pthread_cond_wait(&wal->duravel, &wal->mutex);
+    }
+    pthread_mutex_unlock(&wal->mutex);
+}
+
+/*
+ * Grava as operações pendentes, encerra a thread escritora e libera o WAL.
+ * Deve ser chamada sem threads de atualização ativas.
+ *
+ * @param wal O WAL a ser fechado.
+ */
+void walFechar(Wal *wal)
+{
+    int i;
+
+    walSincronizar(wal);
+
+    pthread_mutex_lock(&wal->mutex);
+    wal->encerrar = true;
+    pthread_cond_signal(&wal->trabalho);
+    pthread_mutex_unlock(&wal->mutex);
+    pthread_join(wal->escritor, NULL);
+
+    close(wal->fd);
+    for (i = 0; i < wal->num_buffers; i++)
+    {
+        pthread_mutex_destroy(&wal->buffers[i].mutex);
+        pthread_cond_destroy(&wal->buffers[i].espaco_livre);
+        free(wal->buffers[i].registros);
+        free(wal->buffers[i].reserva);
+    }
+    pthread_mutex_destroy(&wal->mutex);
+    pthread_mutex_destroy(&wal->mutex_arquivo);
+    pthread_cond_destroy(&wal->trabalho);
+    pthread_cond_destroy(&wal->duravel);
+    free(wal->buffers);
+    free(wal->quantidades);
+    free(wal->posicoes);
+    free(wal->lote_disco);
+    free(wal);
+}
+
+/*
+ * Cria o cache de chaves quentes.
+ *
+ * @param num_conjuntos A quantidade de conjuntos, arredondada para a próxima potência de 2.
+ * @return Um ponteiro para o cache criado.
+ * @note Em caso de falha na alocação, a função imprime uma mensagem de erro e encerra o programa.
+ */
+CacheVizinhos *cacheCriar(int num_conjuntos)
+{
+    CacheVizinhos *cache = (CacheVizinhos *)calloc(1, sizeof(CacheVizinhos));
+    unsigned int n = 1;
+    unsigned int i;
+
+    while (n < (unsigned int)num_conjuntos)
+    {
+        n <<= 1;
+    }
+
+    if (cache == NULL || (cache->conjuntos = (ConjuntoCache *)aligned_alloc(64, n * sizeof(ConjuntoCache))) == NULL)
+    {
+        printf("Erro ao alocar memória\n");
+        exit(1);
+    }
+    memset(cache->conjuntos, 0, n * sizeof(ConjuntoCache));
+    for (i = 0; i < n; i++)
+    {
+        int v;
+
+        atomic_init(&cache->conjuntos[i].seq, 0);
+        for (v = 0; v < CACHE_VIAS; v++)
+        {
+            atomic_init(&cache->conjuntos[i].vias[v].estado, 0);
+        }
+    }
+    for (i = 0; i < CACHE_NIVEIS * CACHE_FAIXAS_POR_NIVEL; i++)
+    {
+        atomic_init(&cache->epocas[i / CACHE_FAIXAS_POR_NIVEL][i % CACHE_FAIXAS_POR_NIVEL], 0);
+    }
+    atomic_init(&cache->epoca_global, 0);
+    cache->mascara = n - 1;
+    atomic_init(&cache->consultas, 0);
+    atomic_init(&cache->acertos, 0);
+    atomic_init(&cache->invalidacoes, 0);
+
+    return cache;
+}
+
+/*
+ * Libera o cache de chaves quentes.
+ *
+ * @param cache O cache a ser liberado.
+ */
+void cacheDestruir(CacheVizinhos *cache)
+{
+    free(cache->conjuntos);
+    free(cache);
+}
+
+/*
+ * Retorna o conjunto do cache responsável por uma chave.
+ */
+ConjuntoCache *cacheConjunto(CacheVizinhos *cache, const int x)
+{
+    uint32_t h = (uint32_t)x * 2654435761u; // Hash multiplicativo, espalha chaves consecutivas
+    return &cache->conjuntos[(h >> 16 ^ h) & cache->mascara];
+}
+
+/*
+ * Deslocamento que define o tamanho das faixas de chaves de cada nível de épocas.
+ */
+static const int CACHE_DESLOCAMENTOS[CACHE_NIVEIS] = {4, 10, 16, 22};
+
+/*
+ * Converte uma chave em um valor sem sinal que preserva a ordem das chaves.
+ */
+uint32_t cacheChaveOrdenada(const int x)
+{
+    return (uint32_t)x ^ 0x80000000u;
+}
+
+/*
+ * Escolhe o nível mais fino em que no máximo duas faixas cobrem o intervalo [minimo, maximo],
+ * ou CACHE_NIVEIS se apenas a época global o cobre.
+ */
+int cacheNivel(uint32_t minimo, uint32_t maximo)
+{
+    int n;
+
+    for (n = 0; n < CACHE_NIVEIS; n++)
+    {
+        if ((maximo >> CACHE_DESLOCAMENTOS[n]) - (minimo >> CACHE_DESLOCAMENTOS[n]) <= 1)
+        {
+            return n;
+        }
+    }
+    return CACHE_NIVEIS;
+}
+
+/*
+ * Soma as épocas das faixas que cobrem o intervalo [minimo, maximo] no nível indicado.
+ */
+unsigned int cacheEpoca(CacheVizinhos *cache, int nivel, uint32_t minimo, uint32_t maximo)
+{
+    uint32_t a, b;
+    unsigned int epoca;
+
+    if (nivel == CACHE_NIVEIS)
+    {
+        return atomic_load_explicit(&cache->epoca_global, memory_order_acquire);
+    }
+
+    a = minimo >> CACHE_DESLOCAMENTOS[nivel];
+    b = maximo >> CACHE_DESLOCAMENTOS[nivel];
+    epoca = atomic_load_explicit(&cache->epocas[nivel][a & (CACHE_FAIXAS_POR_NIVEL - 1)], memory_order_acquire);
+    if (b != a)
+    {
+        epoca += atomic_load_explicit(&cache->epocas[nivel][b & (CACHE_FAIXAS_POR_NIVEL - 1)], memory_order_acquire);
+    }
+    return epoca;
+}
+
+/*
+ * Calcula a época atual do intervalo [predecessor, sucessor] descrito por um estado de entrada.
+ * Um predecessor ou sucessor ausente estende o intervalo até o limite do espaço de chaves.
+ */
+unsigned int cacheEpocaEntrada(CacheVizinhos *cache, unsigned int estado, int predecessor, int sucessor)
+{
+    uint32_t minimo = (estado & CACHE_TEM_PREDECESSOR) ? cacheChaveOrdenada(predecessor) : 0;
+    uint32_t maximo = (estado & CACHE_TEM_SUCESSOR) ? cacheChaveOrdenada(sucessor) : UINT32_MAX;
+
+    return cacheEpoca(cache, (int)(estado >> CACHE_NIVEL_DESLOCAMENTO), minimo, maximo);
+}
+
+/*
+ * Procura uma chave no cache. Pode ser chamada por várias threads sem o mutex da árvore.
+ *
+ * @param cache O cache.
+ * @param x A chave procurada.
+ * @param r Onde o resultado é armazenado em caso de acerto.
+ * @return true se a chave estava no cache e o resultado guardado ainda é válido.
+ */
+bool cacheBuscar(CacheVizinhos *cache, const int x, ResultadoVizinhos *r)
+{
+    ConjuntoCache *c = cacheConjunto(cache, x);
+    unsigned int antes, depois;
+    unsigned int estado = 0, epoca = 0;
+    int predecessor = 0, sucessor = 0;
+    bool achou;
+
+    atomic_fetch_add_explicit(&cache->consultas, 1, memory_order_relaxed);
+
+    do
+    {
+        int i;
+
+        antes = atomic_load_explicit(&c->seq, memory_order_acquire);
+        achou = false;
+        for (i = 0; i < CACHE_VIAS; i++)
+        {
+            EntradaCache *e = &c->vias[i];
+
+            estado = atomic_load_explicit(&e->estado, memory_order_relaxed);
+            if ((estado & CACHE_VALIDA) && atomic_load_explicit(&e->chave, memory_order_relaxed) == x)
+            {
+                predecessor = atomic_load_explicit(&e->predecessor, memory_order_relaxed);
+                sucessor = atomic_load_explicit(&e->sucessor, memory_order_relaxed);
+                epoca = atomic_load_explicit(&e->epoca, memory_order_relaxed);
+                achou = true;
+                break;
+            }
+        }
+        atomic_thread_fence(memory_order_acquire);
+        depois = atomic_load_explicit(&c->seq, memory_order_relaxed);
+    } while ((antes & 1) || antes != depois); // O conjunto foi alterado durante a leitura
+
+    // Uma atualização dentro de [predecessor, sucessor] desde o preenchimento torna a entrada obsoleta
+    if (!achou || cacheEpocaEntrada(cache, estado, predecessor, sucessor) != epoca)
+    {
+        return false;
+    }
+
+    r->presente = (estado & CACHE_PRESENTE) != 0;
+    r->predecessor = predecessor;
+    r->sucessor = sucessor;
+    r->tem_predecessor = (estado & CACHE_TEM_PREDECESSOR) != 0;
+    r->tem_sucessor = (estado & CACHE_TEM_SUCESSOR) != 0;
+    atomic_fetch_add_explicit(&cache->acertos, 1, memory_order_relaxed);
+    return true;
+}
+
+/*
+ * Marca o início e o fim de uma alteração em um conjunto do cache.
+ */
+void cacheIniciarEscrita(ConjuntoCache *c)
+{
+    atomic_store_explicit(&c->seq, atomic_load_explicit(&c->seq, memory_order_relaxed) + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+void cacheTerminarEscrita(ConjuntoCache *c)
+{
+    atomic_store_explicit(&c->seq, atomic_load_explicit(&c->seq, memory_order_relaxed) + 1, memory_order_release);
+}
+
+/*
+ * Guarda o resultado de uma consulta no cache.
+ * Deve ser chamada com o mutex da árvore adquirido, antes de liberá-lo, para que nenhuma
+ * atualização ocorra entre a consulta à árvore e o preenchimento.
+ *
+ * @param cache O cache.
+ * @param x A chave consultada.
+ * @param r O resultado da consulta.
+ */
+void cacheGuardar(CacheVizinhos *cache, const int x, const ResultadoVizinhos *r)
+{
+    ConjuntoCache *c = cacheConjunto(cache, x);
+    EntradaCache *e;
+    uint32_t minimo = r->tem_predecessor ? cacheChaveOrdenada(r->predecessor) : 0;
+    uint32_t maximo = r->tem_sucessor ? cacheChaveOrdenada(r->sucessor) : UINT32_MAX;
+    int nivel = cacheNivel(minimo, maximo);
+    unsigned int estado;
+    int i, via = -1;
+
+    // Prefere uma via vazia, a da própria chave ou uma obsoleta; senão, alterna entre as vias
+    for (i = 0; i < CACHE_VIAS && via < 0; i++)
+    {
+        e = &c->vias[i];
+        estado = atomic_load_explicit(&e->estado, memory_order_relaxed);
+        if (!(estado & CACHE_VALIDA) || atomic_load_explicit(&e->chave, memory_order_relaxed) == x ||
+            cacheEpocaEntrada(cache, estado, atomic_load_explicit(&e->predecessor, memory_order_relaxed),
+                              atomic_load_explicit(&e->sucessor, memory_order_relaxed)) != atomic_load_explicit(&e->epoca, memory_order_relaxed))
+        {
+            via = i;
+        }
+    }
+    if (via < 0)
+    {
+        via = (int)((atomic_load_explicit(&c->seq, memory_order_relaxed) >> 1) % CACHE_VIAS);
+    }
+
+    estado = CACHE_VALIDA | (r->presente ? CACHE_PRESENTE : 0) | (r->tem_predecessor ? CACHE_TEM_PREDECESSOR : 0) |
+             (r->tem_sucessor ? CACHE_TEM_SUCESSOR : 0) | (unsigned int)nivel << CACHE_NIVEL_DESLOCAMENTO;
+
+    cacheIniciarEscrita(c);
+    e = &c->vias[via];
+    atomic_store_explicit(&e->chave, x, memory_order_relaxed);
+    atomic_store_explicit(&e->predecessor, r->predecessor, memory_order_relaxed);
+    atomic_store_explicit(&e->sucessor, r->sucessor, memory_order_relaxed);
+    atomic_store_explicit(&e->epoca, cacheEpoca(cache, nivel, minimo, maximo), memory_order_relaxed);
+    atomic_store_explicit(&e->estado, (unsigned char)estado, memory_order_relaxed);
+    cacheTerminarEscrita(c);
+}
+
+/*
+ * Invalida as entradas cujo resultado pode depender de uma chave inserida ou removida,
+ * incrementando a época da faixa da chave em cada nível e a época global. O custo é constante,
+ * independente do tamanho do cache.
+ * Deve ser chamada com o mutex da árvore adquirido, logo após a alteração.
+ *
+ * @param cache O cache.
+ * @param x A chave inserida ou removida.
+ */
+void cacheInvalidar(CacheVizinhos *cache, const int x)
+{
+    uint32_t u = cacheChaveOrdenada(x);
+    int n;
+
+    for (n = 0; n < CACHE_NIVEIS; n++)
+    {
+        atomic_fetch_add_explicit(&cache->epocas[n][(u >> CACHE_DESLOCAMENTOS[n]) & (CACHE_FAIXAS_POR_NIVEL - 1)], 1, memory_order_release);
+    }
+    atomic_fetch_add_explicit(&cache->epoca_global, 1, memory_order_release);
+    atomic_fetch_add_explicit(&cache->invalidacoes, 1, memory_order_relaxed);
+}
+
+/*
+ * Invalida todas as entradas do cache, por exemplo quando a árvore inteira é descartada.
+ * Deve ser chamada com o mutex da árvore adquirido.
+ *
+ * @param cache O cache.
+ */
+void cacheLimpar(CacheVizinhos *cache)
+{
+    unsigned int i;
+    int v;
+
+    for (i = 0; i <= cache->mascara; i++)
+    {
+        cacheIniciarEscrita(&cache->conjuntos[i]);
+        for (v = 0; v < CACHE_VIAS; v++)
+        {
+            atomic_store_explicit(&cache->conjuntos[i].vias[v].estado, 0, memory_order_relaxed);
+        }
+        cacheTerminarEscrita(&cache->conjuntos[i]);
+    }
+}
+
+/*
+ * Imprime as estatísticas do cache de chaves quentes.
+ *
+ * @param cache O cache.
+ */
+void printEstatisticasCache(CacheVizinhos *cache)
+{
+    unsigned long long consultas = atomic_load(&cache->consultas);
+    unsigned long long acertos = atomic_load(&cache->acertos);
+
+    printf("Cache de chaves quentes: %llu consultas, %llu acertos (%.1f%%), %llu invalidações\n",
+           consultas, acertos, consultas > 0 ? 100.0 * acertos / consultas : 0.0,
+           (unsigned long long)atomic_load(&cache->invalidacoes));
+}
 
 /
-    *Imprime os elementos da árvore AVL em ordem crescente.
+    *Função executada por uma thread para inserir elementos na árvore AVL.
          *
-             *@param t O ponteiro para o nó raiz da árvore.
-                 * /
-    void printArvoreEmOrdem(AvlNode *t)
+             *@param arg Um ponteiro para os dados da thread contendo a árvore,
+    o intervalo de elementos e o mutex.
+            *@ return NULL *
+        /
+        void * inserirThread(void *arg)
+{
+    ThreadData *data = (ThreadData *)arg; // Obtém os dados da thread
+    AvlNode arvore = data->arvore;        // Ponteiro para a raiz da árvore
+    int inicio = data->inicio;            // Valor inicial do intervalo de valores a serem inseridos
+    int fim = data->fim;                  // Valor final do intervalo de valores a serem inseridos
+    DedoAvl dedo;                         // Caminho da última inserção da thread
+    int lote[TAMANHO_LOTE_THREAD];        // Chaves aplicadas com uma única aquisição do mutex
+    int i, j, n;
+
+    dedoIniciar(&dedo);
+
+    // Itera pelo intervalo de valores definido para a thread, um lote por vez
+    for (i = inicio; i <= fim; i += n)
+    {
+        n = fim - i + 1 < TAMANHO_LOTE_THREAD ? fim - i + 1 : TAMANHO_LOTE_THREAD;
+        for (j = 0; j < n; j++)
+        {
+            lote[j] = rand() % ((fim - inicio + 1) * 10) + inicio * 10; // Gera um valor aleatório para inserção
+        }
+        qsort(lote, (size_t)n, sizeof(int), compararInteiros); // Em ordem, cada inserção parte da anterior
+
+        pthread_mutex_lock(data->mutex); // Lock do mutex antes das inserções
+        for (j = 0; j < n; j++)
+        {
+            bool inserido = inserirComDedo(lote[j], arvore, &dedo, data->versao); // Insere o valor na árvore a partir do dedo
+            if (data->cache != NULL && inserido)
+            {
+                cacheInvalidar(data->cache, lote[j]); // Invalida as consultas afetadas pela inserção
+            }
+            if (data->wal != NULL && inserido)
+            {
+                walRegistrar(data->wal, data->id, WAL_OP_INSERIR, lote[j]); // Registra a inserção no WAL
+            }
+        }
+        pthread_mutex_unlock(data->mutex); // Unlock do mutex após as inserções
+    }
+
+    pthread_exit(NULL); // Finaliza a thread
+}
+
+/
+    *Encontra o nó com o valor mínimo na árvore AVL.
+         *
+             *@param t O nó raiz da árvore onde a busca será realizada.
+                 *@ return O ponteiro para o nó com o valor mínimo,
+    ou NULL se a árvore estiver vazia.
+            * /
+        AvlNode *EncontrarMinNode(AvlNode *t)
+{
+    if (t == NULL)
+    {
+        return NULL; // Retorna NULL se a árvore estiver vazia
+    }
+
+    if (t->esquerda == NULL)
+    {
+        return t; // Retorna o próprio nó se não houver filho esquerdo
+    }
+
+    return EncontrarMinNode(t->esquerda); // Recursivamente busca o filho esquerdo até encontrar o nó com o menor valor
+}
+
+/
+    *Encontra o nó com o valor máximo na árvore AVL.
+         *
+             *@param t O nó raiz da árvore onde a busca será realizada.
+                 *@ return O ponteiro para o nó com o valor máximo,
+    ou NULL se a árvore estiver vazia.
+            * /
+        AvlNode *EncontrarMaxNode(AvlNode *t)
+{
+    if (t == NULL)
+    {
+        return NULL;
+    }
+    if (t->direita == NULL)
+    {
+        return t; // Retorna o próprio nó se não houver filho direito
+    }
+    else
+    {
+        return EncontrarMaxNode(t->direita);
+    }
+}
+
+/
+    *Remove um nó com o valor especificado da árvore AVL.
+         *
+             *@param x O valor a ser removido.
+                 *@param t O ponteiro para o nó raiz da árvore.
+                     *@param removerElemento O ponteiro para a variável onde o elemento removido será armazenado.
+                         * /
+    void removerNode(const int x, AvlNode t, int *removerElemento)
+{
+    // Implementação da função removerNode partes do código do livro "Data Structures and Algorithm Analysis in C++." por Autor do Livro (página 157)
+
+    if (*t == NULL)
+    {
+        return; // Retorna se a árvore estiver vazia
+    }
+
+    if (x < (*t)->elemento)
+    {
+        removerNode(x, &((*t)->esquerda), removerElemento); // Chama a função recursivamente para a subárvore esquerda
+    }
+    else if (x > (*t)->elemento)
+    {
+        removerNode(x, &((*t)->direita), removerElemento); // Chama a função recursivamente para a subárvore direita
+    }
+    else if ((*t)->esquerda != NULL && (*t)->direita != NULL)
+    {
+        // Nó a ser removido tem dois filhos
+        AvlNode *nodeParaRemover = *t;
+        AvlNode *minNode = EncontrarMinNode(nodeParaRemover->direita);  // Encontra o nó com o menor valor na subárvore direita
+        *removerElemento = minNode->elemento;                           // Armazena o elemento a ser removido
+        (*t)->elemento = minNode->elemento;                             // Substitui o elemento do nó atual pelo elemento do nó encontrado
+        removerNode((*t)->elemento, &((*t)->direita), removerElemento); // Remove o nó encontrado recursivamente
+    }
+    else
+    {
+        // Nó a ser removido tem zero ou um filho
+        AvlNode *nodeParaRemover = *t;
+        *t = ((*t)->esquerda != NULL) ? (*t)->esquerda : (*t)->direita; // Substitui o nó atual pelo seu filho (se existir)
+        *removerElemento = nodeParaRemover->elemento;                   // Armazena o elemento a ser removido
+        free(nodeParaRemover);                                          // Libera a memória do nó removido
+    }
+
+    // Atualiza a altura do nó pai e realiza o balanceamento, se necessário
+    if (*t != NULL)
+    {
+        (*t)->altura = max(altura((*t)->esquerda), altura((*t)->direita)) + 1;
+        balancear(t);
+    }
+}
+
+/*
+ * Remove um elemento da árvore AVL partindo do dedo em vez da raiz.
+ * A remoção recursiva começa no nó com o elemento, localizado a partir do dedo, e o
+ * rebalanceamento sobe pelo caminho do dedo até que a altura se estabilize.
+ *
+ * @param x O valor a ser removido.
+ * @param t O endereço da raiz da árvore.
+ * @param dedo O dedo da thread.
+ * @param versao O contador de versão da árvore, incrementado a cada modificação.
+ * @return true se o elemento foi removido, false se ele não estava na árvore.
+ */
+bool removerComDedo(const int x, AvlNode **t, DedoAvl *dedo, unsigned long *versao)
+{
+    int i;
+    int removerElemento; // Exigido por removerNode, que nele guarda o valor do nó substituído
+
+    dedoLocalizar(dedo, t, x, *versao);
+    i = dedoDescer(dedo, x);
+
+    // O elemento não existe na árvore
+    if (*dedo->caminho[i] == NULL)
+    {
+        return false;
+    }
+
+    int altura_anterior = (*dedo->caminho[i])->altura;
+    removerNode(x, dedo->caminho[i], &removerElemento);
+
+    if (altura(*dedo->caminho[i]) != altura_anterior)
+    {
+        dedoRebalancear(dedo, i - 1);
+    }
+
+    (*versao)++;
+    dedo->versao = *versao;
+    return true;
+}
+
+/
+    *Imprime os elementos da árvore AVL em ordem crescente.
+         *
+             *@param t O ponteiro para o nó raiz da árvore.
+                 * /
+    void printArvoreEmOrdem(AvlNode *t)
+{
+    if (t != NULL)
+    {
+        printArvoreEmOrdem(t->esquerda); // Recursivamente imprime os elementos da subárvore esquerda.
+        printf("%d ", t->elemento);      // Imprime o elemento do nó atual.
+        printArvoreEmOrdem(t->direita);  // Recursivamente imprime os elementos da subárvore direita.
+    }
+}
+
+/
+        *Imprime os elementos da árvore AVL em pré -
+    ordem.
+            *
+                *@param t O ponteiro para o nó raiz da árvore.
+                    * /
+        void printArvoreEmPreOrdem(AvlNode *t)
+{
+    if (t != NULL)
+    {
+        printf("%d ", t->elemento);         // Imprime o elemento do nó atual.
+        printArvoreEmPreOrdem(t->esquerda); // Recursivamente imprime os elementos da subárvore esquerda.
+        printArvoreEmPreOrdem(t->direita);  // Recursivamente imprime os elementos da subárvore direita.
+    }
+}
+
+/
+        *Imprime os elementos da árvore AVL em pós -
+    ordem.
+            *
+                *@param t O ponteiro para o nó raiz da árvore.
+                    * /
+        void printArvoreEmPosOrdem(AvlNode *t)
+{
+    if (t != NULL)
+    {
+        printArvoreEmPosOrdem(t->esquerda); // Recursivamente imprime os elementos da subárvore esquerda.
+        printArvoreEmPosOrdem(t->direita);  // Recursivamente imprime os elementos da subárvore direita.
+        printf("%d ", t->elemento);         // Imprime o elemento do nó atual.
+    }
+}
+
+/*
+ * Verifica se um elemento está na árvore AVL e encontra os seus sucessor e predecessor.
+ *
+ * @param x O elemento para o qual se deseja encontrar o sucessor e o predecessor.
+ * @param t O ponteiro para o nó raiz da árvore.
+ * @param r Onde o resultado é armazenado.
+ */
+void encontrarVizinhos(const int x, AvlNode *t, ResultadoVizinhos *r)
+{
+    AvlNode *successor = NULL;   // Ponteiro para o sucessor
+    AvlNode *predecessor = NULL; // Ponteiro para o predecessor
+    AvlNode *current = t;        // Ponteiro para o nó atual
+
+    r->presente = false;
+
+    // Percorre a árvore para encontrar o elemento e seus sucessor e predecessor
+    while (current != NULL)
+    {
+        if (x < current->elemento)
+        {
+            successor = current;
+            current = current->esquerda; // Desce para a subárvore esquerda
+        }
+        else if (x > current->elemento)
+        {
+            predecessor = current;
+            current = current->direita; // Desce para a subárvore direita
+        }
+        else
+        {
+            // Elemento encontrado, encontrando o sucessor e o predecessor se existirem
+            r->presente = true;
+            if (current->direita != NULL)
+            {
+                successor = EncontrarMinNode(current->direita); // Encontra o nó mínimo da subárvore direita
+            }
+            if (current->esquerda != NULL)
+            {
+                predecessor = EncontrarMaxNode(current->esquerda); // Encontra o nó máximo da subárvore esquerda
+            }
+            break;
+        }
+    }
+
+    r->tem_sucessor = successor != NULL;
+    r->sucessor = successor != NULL ? successor->elemento : 0;
+    r->tem_predecessor = predecessor != NULL;
+    r->predecessor = predecessor != NULL ? predecessor->elemento : 0;
+}
+
+/*
+ * Consulta a pertinência de um elemento e os seus sucessor e predecessor, passando primeiro pelo cache
+ * de chaves quentes. Um acerto não adquire o mutex da árvore; uma falta percorre a árvore com
+ * o mutex adquirido e guarda o resultado no cache.
+ *
+ * @param x O elemento consultado.
+ * @param t O ponteiro para o nó raiz da árvore.
+ * @param mutex O mutex que protege a árvore, ou NULL se não há atualizações concorrentes.
+ * @param cache O cache de chaves quentes, ou NULL para consultar sempre a árvore.
+ * @param r Onde o resultado é armazenado.
+ */
+void consultarVizinhos(const int x, AvlNode **t, pthread_mutex_t *mutex, CacheVizinhos *cache, ResultadoVizinhos *r)
+{
+    if (cache != NULL && cacheBuscar(cache, x, r))
+    {
+        return;
+    }
+
+    if (mutex != NULL)
+    {
+        pthread_mutex_lock(mutex);
+    }
+    encontrarVizinhos(x, *t, r);
+    if (cache != NULL)
+    {
+        cacheGuardar(cache, x, r);
+    }
+    if (mutex != NULL)
+    {
+        pthread_mutex_unlock(mutex);
+    }
+}
+
+/*
+ * Imprime o sucessor e o predecessor de um elemento na árvore AVL.
+ *
+ * @param x O elemento para o qual se deseja encontrar o sucessor e o predecessor.
+ * @param t O ponteiro para o nó raiz da árvore.
+ * @param cache O cache de chaves quentes, ou NULL.
+ */
+void printSucessorEPredecessor(const int x, AvlNode *t, CacheVizinhos *cache)
+{
+    ResultadoVizinhos r;
+
+    // Consulta o cache de chaves quentes e, em caso de falta, percorre a árvore
+    consultarVizinhos(x, &t, NULL, cache, &r);
+
+    // Imprime o sucessor, se existir
+    if (r.tem_sucessor)
+    {
+        printf("Sucessor de %d: %d\n", x, r.sucessor);
+    }
+    else
+    {
+        printf("Não há sucessor para %d\n", x);
+    }
+
+    // Imprime o predecessor, se existir
+    if (r.tem_predecessor)
+    {
+        printf("Predecessor de %d: %d\n", x, r.predecessor);
+    }
+    else
+    {
+        printf("Não há predecessor para %d\n", x);
+    }
+}
+
+/
+    *Imprime o elemento mínimo e máximo de uma árvore AVL.
+         *
+             *@param t O ponteiro para o nó raiz da árvore.
+                 * /
+    void printMinMax(AvlNode *t)
+{
+    AvlNode *minNode = EncontrarMinNode(t); // Encontra o nó mínimo da árvore
+    AvlNode *maxNode = EncontrarMaxNode(t); // Encontra o nó máximo da árvore
+
+    // Imprime o elemento mínimo, se existir
+    if (minNode != NULL)
+    {
+        printf("Elemento mínimo: %d\n", minNode->elemento);
+    }
+    else
+    {
+        printf("A árvore está vazia. Não há elemento mínimo.\n");
+    }
+
+    // Imprime o elemento máximo, se existir
+    if (maxNode != NULL)
+    {
+        printf("Elemento máximo: %d\n", maxNode->elemento);
+    }
+    else
+    {
+        printf("A árvore está vazia. Não há elemento máximo.\n");
+    }
+}
+
+/
+    *Função executada por uma thread para remover elementos de uma árvore AVL.
+         *
+             *@param arg O argumento passado para a thread,
+    que contém os dados da thread.
+            *@ return Nenhum valor de retorno.*
+        /
+        void * removerThread(void *arg)
+{
+    ThreadData *data = (ThreadData *)arg; // Obtém os dados da thread
+    AvlNode arvore = data->arvore;        // Ponteiro para a árvore
+    int inicio = data->inicio;            // Índice de início
+    int fim = data->fim;                  // Índice de fim
+    pthread_mutex_t *mutex = data->mutex; // Ponteiro para o mutex
+    DedoAvl dedo;                         // Caminho da última remoção da thread
+    int lote[TAMANHO_LOTE_THREAD];        // Chaves aplicadas com uma única aquisição do mutex
+    int removidos[TAMANHO_LOTE_THREAD];   // Elementos removidos no lote, impressos fora do mutex
+    int n;
+
+    dedoIniciar(&dedo);
+
+    for (int i = inicio; i <= fim; i += n)
+    {
+        int j, quantidade_removidos = 0;
+
+        n = fim - i + 1 < TAMANHO_LOTE_THREAD ? fim - i + 1 : TAMANHO_LOTE_THREAD;
+        for (j = 0; j < n; j++)
+        {
+            lote[j] = rand() % (NUM_ELEMENTOS_ARVORE_PARA_REMOVER * 10); // Gera um valor aleatório para remover
+        }
+        qsort(lote, (size_t)n, sizeof(int), compararInteiros); // Em ordem, cada remoção parte da anterior
+
+        pthread_mutex_lock(mutex); // Lock do mutex antes das remoções
+        for (j = 0; j < n; j++)
+        {
+            if (!removerComDedo(lote[j], arvore, &dedo, data->versao))
+            {
+                continue; // Elemento não encontrado
+            }
+            if (data->cache != NULL)
+            {
+                cacheInvalidar(data->cache, lote[j]); // Invalida as consultas afetadas pela remoção
+            }
+            if (data->wal != NULL)
+            {
+                walRegistrar(data->wal, data->id, WAL_OP_REMOVER, lote[j]); // Registra a remoção no WAL
+            }
+            removidos[quantidade_removidos++] = lote[j];
+        }
+        pthread_mutex_unlock(mutex); // Unlock do mutex após as remoções
+
+        for (j = 0; j < quantidade_removidos; j++)
+        {
+            printf("Elemento removido: %d\n", removidos[j]);
+        }
+    }
+
+    pthread_exit(NULL);
+}
+
+/*
+ * Constrói uma árvore AVL balanceada a partir de um vetor ordenado e sem repetições.
+ *
+ * @param v O vetor ordenado de elementos.
+ * @param inicio O índice do primeiro elemento do intervalo.
+ * @param fim O índice do último elemento do intervalo.
+ * @return O ponteiro para a raiz da árvore construída, ou NULL se o intervalo for vazio.
+ */
+AvlNode *construirArvoreDeVetor(const int *v, long long inicio, long long fim)
+{
+    if (inicio > fim)
+    {
+        return NULL;
+    }
+
+    long long meio = inicio + (fim - inicio) / 2;
+    AvlNode *esq = construirArvoreDeVetor(v, inicio, meio - 1);
+    AvlNode *dir = construirArvoreDeVetor(v, meio + 1, fim);
+    return novoAvlNode(v[meio], esq, dir, max(altura(esq), altura(dir)) + 1);
+}
+
+/*
+ * Grava os elementos da árvore em ordem crescente no arquivo de snapshot.
+ *
+ * @param t O ponteiro para o nó raiz da árvore.
+ * @param f O arquivo de snapshot.
+ */
+void gravarSnapshotEmOrdem(AvlNode *t, FILE *f)
+{
+    if (t != NULL)
+    {
+        int32_t elemento = t->elemento;
+        gravarSnapshotEmOrdem(t->esquerda, f);
+        fwrite(&elemento, sizeof(elemento), 1, f);
+        gravarSnapshotEmOrdem(t->direita, f);
+    }
+}
+
+/*
+ * Grava um snapshot da árvore e trunca o log, cujas operações passam a estar contidas no snapshot.
+ * O snapshot é gravado em um arquivo temporário e renomeado, de forma que uma falha no meio
+ * do checkpoint preserva o snapshot anterior e o log completo.
+ * Deve ser chamada com o mutex da árvore adquirido ou sem threads de atualização ativas.
+ *
+ * @param wal O WAL da árvore.
+ * @param t O ponteiro para o nó raiz da árvore.
+ * @param caminho_snapshot O caminho do arquivo de snapshot.
+ * @return true se o checkpoint foi concluído, false caso contrário.
+ */
+bool walCheckpoint(Wal *wal, AvlNode *t, const char *caminho_snapshot)
+{
+    char caminho_temporario[4096];
+    FILE *f;
+
+    walSincronizar(wal); // O snapshot só pode substituir operações já gravadas no log
+
+    snprintf(caminho_temporario, sizeof(caminho_temporario), "%s.tmp", caminho_snapshot);
+    f = fopen(caminho_temporario, "wb");
+    if (f == NULL)
+    {
+        printf("Erro ao criar o snapshot %s: %s\n", caminho_temporario, strerror(errno));
+        return false;
+    }
+
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+    gravarSnapshotEmOrdem(t, f);
+    if (fflush(f) != 0 || fsync(fileno(f)) != 0)
+    {
+        printf("Erro ao gravar o snapshot %s: %s\n", caminho_temporario, strerror(errno));
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+
+    if (rename(caminho_temporario, caminho_snapshot) != 0)
+    {
+        printf("Erro ao substituir o snapshot %s: %s\n", caminho_snapshot, strerror(errno));
+        return false;
+    }
+
+    // O rename só é durável depois do fsync do diretório; sem ele, uma falha após o truncamento
+    // do log poderia deixar o snapshot anterior com o log vazio
+    if (!sincronizarDiretorio(caminho_snapshot))
+    {
+        return false;
+    }
+
+    // Com o snapshot em disco, as operações do log já não são necessárias
+    pthread_mutex_lock(&wal->mutex_arquivo);
+    if (ftruncate(wal->fd, 0) != 0 || fdatasync(wal->fd) != 0)
+    {
+        printf("Erro ao truncar o log: %s\n", strerror(errno));
+        pthread_mutex_unlock(&wal->mutex_arquivo);
+        return false;
+    }
+    pthread_mutex_unlock(&wal->mutex_arquivo);
+
+    return true;
+}
+
+/*
+ * Verifica se um registro lido do log é válido.
+ */
+bool walRegistroValido(const RegistroWalDisco *r)
+{
+    return (r->operacao == WAL_OP_INSERIR || r->operacao == WAL_OP_REMOVER || r->operacao == WAL_OP_LIMPAR) &&
+           r->verificacao == walVerificacao(r->chave, r->operacao);
+}
+
+/*
+ * Procura no log o último registro WAL_OP_LIMPAR válido.
+ *
+ * @param fd O descritor do arquivo de log, posicionado no início.
+ * @return A posição logo após o último WAL_OP_LIMPAR, ou -1 se o log não tem nenhum.
+ */
+off_t walUltimaLimpeza(int fd)
+{
+    RegistroWalDisco bloco[4096];
+    off_t posicao = 0, limpeza = -1;
+    ssize_t lidos;
+
+    while ((lidos = read(fd, bloco, sizeof(bloco))) > 0)
+    {
+        int i, quantidade = (int)(lidos / (ssize_t)sizeof(RegistroWalDisco));
+
+        for (i = 0; i < quantidade; i++)
+        {
+            if (!walRegistroValido(&bloco[i]))
+            {
+                return limpeza;
+            }
+            posicao += (off_t)sizeof(RegistroWalDisco);
+            if (bloco[i].operacao == WAL_OP_LIMPAR)
+            {
+                limpeza = posicao;
+            }
+        }
+    }
+
+    return limpeza;
+}
+
+/*
+ * Recupera a árvore carregando o último snapshot e reaplicando as operações do log.
+ * Se o log contém um WAL_OP_LIMPAR, o snapshot e os registros anteriores a ele são ignorados.
+ * Um registro incompleto ou inválido no fim do log (gravação interrompida por uma falha)
+ * encerra a reaplicação, e o log é truncado nesse ponto para receber novos registros.
+ *
+ * @param t O endereço da raiz da árvore, que deve estar vazia.
+ * @param caminho_log O caminho do arquivo de log.
+ * @param caminho_snapshot O caminho do arquivo de snapshot.
+ * @return A quantidade de operações reaplicadas a partir do log.
+ */
+long long walRecuperar(AvlNode **t, const char *caminho_log, const char *caminho_snapshot)
+{
+    FILE *f;
+    long long reaplicadas = 0;
+    off_t valido = 0;
+    int fd = open(caminho_log, O_RDWR);
+
+    // Uma limpeza registrada no log descarta o snapshot, que pode ser anterior a ela
+    if (fd >= 0 && (valido = walUltimaLimpeza(fd)) >= 0)
+    {
+        f = NULL;
+    }
+    else
+    {
+        valido = 0;
+        f = fopen(caminho_snapshot, "rb");
+    }
+
+    // Carrega o snapshot, gravado em ordem crescente
+    if (f != NULL)
+    {
+        long tamanho;
+        long long n;
+        int *elementos;
+
+        fseek(f, 0, SEEK_END);
+        tamanho = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        n = tamanho / (long)sizeof(int32_t);
+
+        elementos = (int *)malloc((size_t)(n > 0 ? n : 1) * sizeof(int));
+        if (elementos == NULL)
+        {
+            printf("Erro ao alocar memória\n");
+            exit(1);
+        }
+        n = (long long)fread(elementos, sizeof(int32_t), (size_t)n, f);
+        fclose(f);
+
+        *t = construirArvoreDeVetor(elementos, 0, n - 1);
+        free(elementos);
+    }
+
+    // Reaplica o log sobre o snapshot, a partir da última limpeza
+    if (fd < 0)
+    {
+        return 0;
+    }
+    lseek(fd, valido, SEEK_SET);
+
+    RegistroWalDisco bloco[4096];
+    bool fim = false;
+    while (!fim)
+    {
+        ssize_t lidos = read(fd, bloco, sizeof(bloco));
+        int i, quantidade;
+
+        if (lidos <= 0)
+        {
+            break;
+        }
+
+        quantidade = (int)(lidos / (ssize_t)sizeof(RegistroWalDisco));
+        if (quantidade * (ssize_t)sizeof(RegistroWalDisco) != lidos)
+        {
+            fim = true; // Registro parcialmente gravado no fim do log
+        }
+
+        for (i = 0; i < quantidade; i++)
+        {
+            RegistroWalDisco *r = &bloco[i];
+            int removido = -1;
+
+            if (!walRegistroValido(r))
+            {
+                fim = true;
+                break;
+            }
+
+            if (r->operacao == WAL_OP_INSERIR)
+            {
+                inserir(r->chave, t);
+            }
+            else if (r->operacao == WAL_OP_REMOVER)
+            {
+                removerNode(r->chave, t, &removido);
+            }
+            valido += (off_t)sizeof(RegistroWalDisco);
+            reaplicadas++;
+        }
+    }
+
+    // Descarta o trecho inválido para que novos registros fiquem logo após o último válido
+    if (ftruncate(fd, valido) != 0 || fdatasync(fd) != 0)
+    {
+        printf("Erro ao truncar o log: %s\n", strerror(errno));
+    }
+    close(fd);
+
+    return reaplicadas;
+}
+
+/*
+ * Retorna o tempo decorrido em segundos de um relógio monotônico.
+ *
+ * @return O instante atual, em segundos.
+ */
+double tempoAtual()
+{
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return agora.tv_sec + agora.tv_nsec / 1e9;
+}
+
+/*
+ * Popula a árvore com NUM_THREADS threads de inserção.
+ * Quando o WAL é informado, o tempo medido inclui a gravação em disco de todas as inserções.
+ *
+ * @param t O endereço da raiz da árvore.
+ * @param mutex O mutex que protege a árvore.
+ * @param versao O contador de versão da árvore.
+ * @param cache O cache de chaves quentes da árvore, ou NULL.
+ * @param wal O WAL da árvore, ou NULL para operar apenas em memória.
+ * @return O tempo de parede da população, em segundos.
+ */
+double popularArvoreParalela(AvlNode **t, pthread_mutex_t *mutex, unsigned long *versao, CacheVizinhos *cache, Wal *wal)
+{
+    pthread_t threads[NUM_THREADS];
+    ThreadData thread_data[NUM_THREADS];
+    int elementos_por_thread = NUM_ELEMENTOS_ARVORE / NUM_THREADS;
+    double inicio_tempo = tempoAtual();
+    int i;
+
+    for (i = 0; i < NUM_THREADS; i++)
+    {
+        // Define o intervalo de elementos para a thread
+        int inicio = i * elementos_por_thread;
+        int fim = inicio + elementos_por_thread - 1;
+
+        // Define os dados da thread
+        thread_data[i].arvore = t;
+        thread_data[i].inicio = inicio;
+        thread_data[i].fim = fim;
+        thread_data[i].mutex = mutex;
+        thread_data[i].wal = wal;
+        thread_data[i].id = i;
+        thread_data[i].versao = versao;
+        thread_data[i].cache = cache;
+
+        // Cria a thread
+        pthread_create(&threads[i], NULL, inserirThread, (void *)&thread_data[i]);
+    }
+
+    // Aguarda as threads terminarem
+    for (i = 0; i < NUM_THREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    // As inserções só contam como concluídas quando estão no disco
+    if (wal != NULL)
+    {
+        walSincronizar(wal);
+    }
+
+    return tempoAtual() - inicio_tempo;
+}
+
+/*
+ * Inicializa uma fila limitada.
+ *
+ * @param fila A fila a ser inicializada.
+ * @param capacidade A quantidade máxima de itens na fila.
+ * @param produtores A quantidade de produtores que irão encerrar a fila.
+ */
+void filaIniciar(FilaLimitada *fila, int capacidade, int produtores)
+{
+    fila->itens = (void **)malloc((size_t)capacidade * sizeof(void *));
+    if (fila->itens == NULL)
+    {
+        printf("Erro ao alocar memória\n");
+        exit(1);
+    }
+    fila->capacidade = capacidade;
+    fila->inicio = 0;
+    fila->quantidade = 0;
+    fila->produtores = produtores;
+    pthread_mutex_init(&fila->mutex, NULL);
+    pthread_cond_init(&fila->nao_cheia, NULL);
+    pthread_cond_init(&fila->nao_vazia, NULL);
+}
+
+/*
+ * Insere um item na fila, aguardando enquanto ela estiver cheia.
+ *
+ * @param fila A fila.
+ * @param item O item a ser inserido.
+ */
+void filaInserir(FilaLimitada *fila, void *item)
+{
+    pthread_mutex_lock(&fila->mutex);
+    while (fila->quantidade == fila->capacidade)
+    {
+        pthread_cond_wait(&fila->nao_cheia, &fila->mutex);
+    }
+    fila->itens[(fila->inicio + fila->quantidade) % fila->capacidade] = item;
+    fila->quantidade++;
+    pthread_cond_signal(&fila->nao_vazia);
+    pthread_mutex_unlock(&fila->mutex);
+}
+
+/*
+ * Retira um item da fila, aguardando enquanto ela estiver vazia.
+ *
+ * @param fila A fila.
+ * @return O item retirado, ou NULL se a fila estiver vazia e todos os produtores tiverem terminado.
+ */
+void *filaRetirar(FilaLimitada *fila)
+{
+    void *item = NULL;
+
+    pthread_mutex_lock(&fila->mutex);
+    while (fila->quantidade == 0 && fila->produtores > 0)
+    {
+        pthread_cond_wait(&fila->nao_vazia, &fila->mutex);
+    }
+    if (fila->quantidade > 0)
+    {
+        item = fila->itens[fila->inicio];
+        fila->inicio = (fila->inicio + 1) % fila->capacidade;
+        fila->quantidade--;
+        pthread_cond_signal(&fila->nao_cheia);
+    }
+    pthread_mutex_unlock(&fila->mutex);
+
+    return item;
+}
+
+/*
+ * Indica que um produtor terminou. Quando o último produtor termina, os consumidores
+ * bloqueados são acordados e passam a receber NULL assim que a fila esvaziar.
+ *
+ * @param fila A fila.
+ */
+void filaEncerrarProdutor(FilaLimitada *fila)
+{
+    pthread_mutex_lock(&fila->mutex);
+    if (--fila->produtores == 0)
+    {
+        pthread_cond_broadcast(&fila->nao_vazia);
+    }
+    pthread_mutex_unlock(&fila->mutex);
+}
+
+/*
+ * Libera os recursos de uma fila limitada vazia.
+ *
+ * @param fila A fila.
+ */
+void filaDestruir(FilaLimitada *fila)
+{
+    pthread_mutex_destroy(&fila->mutex);
+    pthread_cond_destroy(&fila->nao_cheia);
+    pthread_cond_destroy(&fila->nao_vazia);
+    free(fila->itens);
+}
+
+/*
+ * Função executada pela thread leitora da ingestão.
+ * Lê a entrada em blocos grandes e corta cada bloco na última fronteira de chave completa;
+ * o restante é copiado para o início do próximo bloco. Um trecho sem nenhum separador é
+ * levado inteiro para o próximo bloco, que cresce para comportá-lo, de forma que uma chave
+ * nunca é dividida entre dois blocos. Enquanto os parsers processam um bloco, o leitor já
+ * preenche o seguinte.
+ *
+ * @param arg Um ponteiro para o estado da ingestão.
+ * @return NULL
+ */
+void *leitorIngestaoThread(void *arg)
+{
+    Ingestao *ing = (Ingestao *)arg;
+    size_t capacidade_restante = ing->tamanho_bloco;
+    char *restante = (char *)malloc(capacidade_restante);
+    size_t tamanho_restante = 0;
+    bool fim_entrada = false;
+
+    if (restante == NULL)
+    {
+        printf("Erro ao alocar memória\n");
+        exit(1);
+    }
+
+    while (!fim_entrada)
+    {
+        BlocoIngestao *bloco = (BlocoIngestao *)malloc(sizeof(BlocoIngestao));
+        size_t capacidade = tamanho_restante + ing->tamanho_bloco; // Sempre lê um bloco inteiro de dados novos
+        size_t tamanho, corte;
+
+        if (bloco == NULL || (bloco->dados = (char *)malloc(capacidade)) == NULL)
+        {
+            printf("Erro ao alocar memória\n");
+            exit(1);
+        }
+
+        // O bloco começa com o trecho incompleto do bloco anterior
+        memcpy(bloco->dados, restante, tamanho_restante);
+        tamanho = tamanho_restante;
+
+        // Pipes entregam leituras parciais, então lê até encher o bloco
+        while (tamanho < capacidade)
+        {
+            ssize_t lidos = read(ing->fd, bloco->dados + tamanho, capacidade - tamanho);
+            if (lidos < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (lidos < 0)
+            {
+                printf("Erro ao ler a entrada: %s\n", strerror(errno));
+                exit(1);
+            }
+            if (lidos == 0)
+            {
+                fim_entrada = true;
+                break;
+            }
+            tamanho += (size_t)lidos;
+            ing->bytes_lidos += lidos;
+        }
+
+        // Corta o bloco na última chave completa
+        if (fim_entrada)
+        {
+            corte = ing->binaria ? tamanho - tamanho % sizeof(int32_t) : tamanho;
+            ing->bytes_descartados = (long long)(tamanho - corte); // Não há mais dados para completar o registro
+        }
+        else if (ing->binaria)
+        {
+            corte = tamanho - tamanho % sizeof(int32_t);
+        }
+        else
+        {
+            corte = tamanho;
+            while (corte > 0 && bloco->dados[corte - 1] != '\n' && bloco->dados[corte - 1] != ' ' &&
+                   bloco->dados[corte - 1] != '\t' && bloco->dados[corte - 1] != '\r' && bloco->dados[corte - 1] != ',')
+            {
+                corte--;
+            }
+            // Sem nenhum separador, o bloco inteiro segue para o próximo (corte igual a 0)
+        }
+
+        tamanho_restante = tamanho - corte;
+        if (tamanho_restante > capacidade_restante)
+        {
+            capacidade_restante = tamanho_restante;
+            restante = (char *)realloc(restante, capacidade_restante);
+            if (restante == NULL)
+            {
+                printf("Erro ao alocar memória\n");
+                exit(1);
+            }
+        }
+        memcpy(restante, bloco->dados + corte, tamanho_restante);
+
+        if (corte == 0)
+        {
+            free(bloco->dados);
+            free(bloco);
+            continue;
+        }
+        bloco->tamanho = corte;
+        filaInserir(&ing->blocos, bloco);
+    }
+
+    free(restante);
+    filaEncerrarProdutor(&ing->blocos);
+    pthread_exit(NULL);
+}
+
+/*
+ * Função executada pelas threads de parsing da ingestão.
+ * Converte cada bloco em um lote de chaves e, se configurado, ordena o lote para que
+ * a inserção percorra a árvore em ordem.
+ *
+ * @param arg Um ponteiro para o estado da ingestão.
+ * @return NULL
+ */
+void *parserIngestaoThread(void *arg)
+{
+    Ingestao *ing = (Ingestao *)arg;
+    BlocoIngestao *bloco;
+
+    while ((bloco = (BlocoIngestao *)filaRetirar(&ing->blocos)) != NULL)
+    {
+        LoteChaves *lote = (LoteChaves *)malloc(sizeof(LoteChaves));
+        size_t maximo = ing->binaria ? bloco->tamanho / sizeof(int32_t) : bloco->tamanho / 2 + 1;
+
+        if (lote == NULL || (lote->chaves = (int *)malloc(maximo * sizeof(int))) == NULL)
+        {
+            printf("Erro ao alocar memória\n");
+            exit(1);
+        }
+        lote->quantidade = 0;
+        lote->rejeitadas = 0;
+
+        if (ing->binaria)
+        {
+            memcpy(lote->chaves, bloco->dados, maximo * sizeof(int32_t));
+            lote->quantidade = (int)maximo;
+        }
+        else
+        {
+            const char *p = bloco->dados;
+            const char *fim = bloco->dados + bloco->tamanho;
+
+            while (p < fim)
+            {
+                bool negativo = false;
+                long long valor = 0;
+                long long limite;
+
+                // Ignora separadores e qualquer caractere que não inicie um número
+                while (p < fim && !(*p >= '0' && *p <= '9') && !(*p == '-' && p + 1 < fim && p[1] >= '0' && p[1] <= '9'))
+                {
+                    p++;
+                }
+                if (p == fim)
+                {
+                    break;
+                }
+                if (*p == '-')
+                {
+                    negativo = true;
+                    p++;
+                }
+                limite = negativo ? -(long long)INT_MIN : INT_MAX;
+                while (p < fim && *p >= '0' && *p <= '9')
+                {
+                    if (valor <= limite)
+                    {
+                        valor = valor * 10 + (*p - '0'); // Para de acumular ao passar do limite, evitando overflow
+                    }
+                    p++;
+                }
+
+                // Chaves fora do intervalo de int são descartadas e contabilizadas
+                if (valor > limite)
+                {
+                    lote->rejeitadas++;
+                    continue;
+                }
+                lote->chaves[lote->quantidade++] = (int)(negativo ? -valor : valor);
+            }
+        }
+
+        free(bloco->dados);
+        free(bloco);
+
+        if (ing->ordenar)
+        {
+            qsort(lote->chaves, (size_t)lote->quantidade, sizeof(int), compararInteiros);
+        }
+        filaInserir(&ing->lotes, lote);
+    }
+
+    filaEncerrarProdutor(&ing->lotes);
+    pthread_exit(NULL);
+}
+
+/*
+ * Função executada pelas threads de inserção da ingestão.
+ * Cada lote é inserido com uma única aquisição do mutex da árvore.
+ *
+ * @param arg Um ponteiro para os parâmetros do estágio.
+ * @return NULL
+ */
+void *inseridorIngestaoThread(void *arg)
 {
-    if (t != NULL)
+    EstagioIngestao *estagio = (EstagioIngestao *)arg;
+    Ingestao *ing = estagio->ingestao;
+    LoteChaves *lote;
+    DedoAvl dedo; // Com lotes ordenados, cada inserção parte do nó inserido antes dela
+
+    dedoIniciar(&dedo);
+
+    while ((lote = (LoteChaves *)filaRetirar(&ing->lotes)) != NULL)
     {
-        printArvoreEmOrdem(t->esquerda); // Recursivamente imprime os elementos da subárvore esquerda.
-        printf("%d ", t->elemento);      // Imprime o elemento do nó atual.
-        printArvoreEmOrdem(t->direita);  // Recursivamente imprime os elementos da subárvore direita.
+        int i;
+
+        pthread_mutex_lock(ing->mutex);
+        for (i = 0; i < lote->quantidade; i++)
+        {
+            if (!inserirComDedo(lote->chaves[i], ing->arvore, &dedo, ing->versao))
+            {
+                continue; // Chave repetida, a árvore não mudou
+            }
+            if (ing->cache != NULL)
+            {
+                cacheInvalidar(ing->cache, lote->chaves[i]);
+            }
+            if (ing->wal != NULL)
+            {
+                walRegistrar(ing->wal, estagio->id, WAL_OP_INSERIR, lote->chaves[i]);
+            }
+        }
+        ing->chaves_lidas += lote->quantidade;
+        ing->rejeitadas += lote->rejeitadas;
+        pthread_mutex_unlock(ing->mutex);
+
+        free(lote->chaves);
+        free(lote);
     }
+
+    pthread_exit(NULL);
 }
 
-/
-        *Imprime os elementos da árvore AVL em pré -
-    ordem.
-            *
-                *@param t O ponteiro para o nó raiz da árvore.
-                    * /
-        void printArvoreEmPreOrdem(AvlNode *t)
+/*
+ * Popula a árvore a partir de um arquivo ou da entrada padrão.
+ * A leitura, o parsing e a inserção executam em estágios paralelos ligados por filas limitadas,
+ * de forma que a E/S e o parsing se sobrepõem às atualizações da árvore.
+ *
+ * @param t O endereço da raiz da árvore.
+ * @param mutex O mutex que protege a árvore.
+ * @param versao O contador de versão da árvore.
+ * @param cache O cache de chaves quentes da árvore, ou NULL.
+ * @param wal O WAL da árvore, ou NULL para operar apenas em memória.
+ * @param caminho O caminho do arquivo, ou "-" para a entrada padrão.
+ * @return O tempo de parede da ingestão, em segundos, ou -1 se a entrada não puder ser aberta.
+ */
+double ingerirArquivo(AvlNode **t, pthread_mutex_t *mutex, unsigned long *versao, CacheVizinhos *cache, Wal *wal, const char *caminho)
 {
-    if (t != NULL)
+    Ingestao ing;
+    pthread_t leitor;
+    pthread_t parsers[INGESTAO_THREADS_PARSER];
+    pthread_t inseridores[NUM_THREADS];
+    EstagioIngestao estagios[NUM_THREADS];
+    double inicio_tempo, tempo;
+    int i;
+
+    memset(&ing, 0, sizeof(ing));
+    ing.fd = strcmp(caminho, "-") == 0 ? STDIN_FILENO : open(caminho, O_RDONLY);
+    if (ing.fd < 0)
     {
-        printf("%d ", t->elemento);         // Imprime o elemento do nó atual.
-        printArvoreEmPreOrdem(t->esquerda); // Recursivamente imprime os elementos da subárvore esquerda.
-        printArvoreEmPreOrdem(t->direita);  // Recursivamente imprime os elementos da subárvore direita.
+        printf("Erro ao abrir %s: %s\n", caminho, strerror(errno));
+        return -1;
+    }
+    posix_fadvise(ing.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    ing.binaria = INGESTAO_BINARIA;
+    ing.ordenar = INGESTAO_ORDENAR_LOTES;
+    ing.tamanho_bloco = (size_t)INGESTAO_TAMANHO_BLOCO;
+    ing.arvore = t;
+    ing.mutex = mutex;
+    ing.versao = versao;
+    ing.cache = cache;
+    ing.wal = wal;
+    filaIniciar(&ing.blocos, INGESTAO_PROFUNDIDADE_FILA, 1);
+    filaIniciar(&ing.lotes, INGESTAO_PROFUNDIDADE_FILA, INGESTAO_THREADS_PARSER);
+
+    inicio_tempo = tempoAtual();
+
+    pthread_create(&leitor, NULL, leitorIngestaoThread, (void *)&ing);
+    for (i = 0; i < INGESTAO_THREADS_PARSER; i++)
+    {
+        pthread_create(&parsers[i], NULL, parserIngestaoThread, (void *)&ing);
+    }
+    for (i = 0; i < NUM_THREADS; i++)
+    {
+        estagios[i].ingestao = &ing;
+        estagios[i].id = i;
+        pthread_create(&inseridores[i], NULL, inseridorIngestaoThread, (void *)&estagios[i]);
+    }
+
+    // Aguarda os estágios terminarem, na ordem do pipeline
+    pthread_join(leitor, NULL);
+    for (i = 0; i < INGESTAO_THREADS_PARSER; i++)
+    {
+        pthread_join(parsers[i], NULL);
     }
+    for (i = 0; i < NUM_THREADS; i++)
+    {
+        pthread_join(inseridores[i], NULL);
+    }
+
+    // As chaves só contam como ingeridas quando estão no disco
+    if (wal != NULL)
+    {
+        walSincronizar(wal);
+    }
+
+    tempo = tempoAtual() - inicio_tempo;
+
+    if (ing.fd != STDIN_FILENO)
+    {
+        close(ing.fd);
+    }
+    filaDestruir(&ing.blocos);
+    filaDestruir(&ing.lotes);
+
+    printf("Ingestão: %lld chaves, %.1f MB em %f segundos (%.0f chaves/s, %.1f MB/s)\n",
+           ing.chaves_lidas, ing.bytes_lidos / 1e6, tempo,
+           ing.chaves_lidas / tempo, ing.bytes_lidos / 1e6 / tempo);
+    if (ing.rejeitadas > 0)
+    {
+        printf("Ingestão: %lld chaves descartadas por estarem fora do intervalo de int\n", ing.rejeitadas);
+    }
+    if (ing.bytes_descartados > 0)
+    {
+        printf("Ingestão: %lld bytes descartados no fim da entrada binária (registro int32 incompleto)\n", ing.bytes_descartados);
+    }
+
+    return tempo;
 }
 
-/
-        *Imprime os elementos da árvore AVL em pós -
-    ordem.
-            *
-                *@param t O ponteiro para o nó raiz da árvore.
-                    * /
-        void printArvoreEmPosOrdem(AvlNode *t)
+/*
+ * Função executada por uma thread para consultar sucessores e predecessores com distribuição
+ * concentrada: 90% das consultas caem em CACHE_CHAVES_QUENTES chaves e o restante é uniforme.
+ *
+ * @param arg Um ponteiro para os dados da thread.
+ * @return NULL
+ */
+void *consultarThread(void *arg)
 {
-    if (t != NULL)
+    ThreadData *data = (ThreadData *)arg;
+    int limite = NUM_ELEMENTOS_ARVORE * 10;
+    unsigned int semente = (unsigned int)data->id * 7919u + 1u; // Semente própria, rand() é compartilhado entre threads
+    int i;
+
+    for (i = data->inicio; i <= data->fim; i++)
     {
-        printArvoreEmPosOrdem(t->esquerda); // Recursivamente imprime os elementos da subárvore esquerda.
-        printArvoreEmPosOrdem(t->direita);  // Recursivamente imprime os elementos da subárvore direita.
-        printf("%d ", t->elemento);         // Imprime o elemento do nó atual.
+        ResultadoVizinhos r;
+        int valor;
+
+        if (rand_r(&semente) % 10 != 0)
+        {
+            valor = (int)((unsigned int)(rand_r(&semente) % CACHE_CHAVES_QUENTES) * 2654435761u % (unsigned int)limite);
+        }
+        else
+        {
+            valor = rand_r(&semente) % limite;
+        }
+
+        consultarVizinhos(valor, data->arvore, data->mutex, data->cache, &r);
     }
+
+    pthread_exit(NULL);
 }
 
-/
-    *Imprime o sucessor e o predecessor de um elemento na árvore AVL.
-         *
-             *@param x O elemento para o qual se deseja encontrar o sucessor e o predecessor.
-                 *@param t O ponteiro para o nó raiz da árvore.
-                     * /
-    void printSucessorEPredecessor(const int x, AvlNode *t)
+/*
+ * Libera todos os nós de uma subárvore sem recursão e sem pilha auxiliar.
+ * Enquanto o nó atual tiver filho esquerdo, uma rotação à direita o leva para cima; sem filho
+ * esquerdo, o nó é liberado e o percurso segue pelo filho direito. Cada nó é rotacionado no
+ * máximo uma vez, então o custo é linear e independe da altura da árvore.
+ *
+ * @param t O ponteiro para o nó raiz da subárvore.
+ * @return A quantidade de nós liberados.
+ */
+long long liberarSubarvore(AvlNode *t)
 {
-    AvlNode *successor = NULL;   // Ponteiro para o sucessor
-    AvlNode *predecessor = NULL; // Ponteiro para o predecessor
-    AvlNode *current = t;        // Ponteiro para o nó atual
+    long long liberados = 0;
 
-    // Percorre a árvore para encontrar o elemento e seus sucessor e predecessor
-    while (current != NULL)
+    while (t != NULL)
     {
-        if (x < current->elemento)
+        if (t->esquerda != NULL)
         {
-            successor = current;
-            current = current->esquerda; // Desce para a subárvore esquerda
+            AvlNode *esq = t->esquerda;
+            t->esquerda = esq->direita;
+            esq->direita = t;
+            t = esq;
         }
-        else if (x > current->elemento)
+        else
         {
-            predecessor = current;
-            current = current->direita; // Desce para a subárvore direita
+            AvlNode *dir = t->direita;
+            free(t);
+            liberados++;
+            t = dir;
         }
-        else
+    }
+
+    return liberados;
+}
+
+/*
+ * Função executada pelas threads de destruição: libera subárvores até que não reste nenhuma.
+ *
+ * @param arg Um ponteiro para o estado da destruição.
+ * @return NULL
+ */
+void *liberarSubarvoresThread(void *arg)
+{
+    DestruicaoArvore *d = (DestruicaoArvore *)arg;
+    int i;
+
+    while ((i = atomic_fetch_add(&d->proxima, 1)) < d->quantidade)
+    {
+        atomic_fetch_add(&d->liberados, liberarSubarvore(d->subarvores[i]));
+    }
+
+    pthread_exit(NULL);
+}
+
+/*
+ * Função executada pela thread coordenadora da destruição.
+ * Libera os níveis superiores da árvore em largura até obter subárvores suficientes para
+ * ocupar todas as threads, e então as distribui entre as threads de destruição.
+ *
+ * @param arg Um ponteiro para o estado da destruição.
+ * @return NULL
+ */
+void *coordenarDestruicaoThread(void *arg)
+{
+    DestruicaoArvore *d = (DestruicaoArvore *)arg;
+    int alvo = d->num_threads * 8; // Várias subárvores por thread equilibram subárvores de tamanhos diferentes
+    AvlNode **nivel = (AvlNode **)malloc((size_t)alvo * 2 * sizeof(AvlNode *));
+    AvlNode **proximo = (AvlNode **)malloc((size_t)alvo * 2 * sizeof(AvlNode *));
+    pthread_t threads[d->num_threads];
+    long long liberados = 0;
+    int n = 0, i;
+
+    if (nivel == NULL || proximo == NULL)
+    {
+        printf("Erro ao alocar memória\n");
+        exit(1);
+    }
+
+    if (d->raiz != NULL)
+    {
+        nivel[n++] = d->raiz;
+    }
+
+    // Cada nível tem no máximo o dobro de nós do anterior, então cabe em 2 * alvo
+    while (n > 0 && n < alvo)
+    {
+        int m = 0;
+
+        for (i = 0; i < n; i++)
         {
-            // Elemento encontrado, encontrando o sucessor e o predecessor se existirem
-            if (current->direita != NULL)
+            if (nivel[i]->esquerda != NULL)
             {
-                successor = EncontrarMinNode(current->direita); // Encontra o nó mínimo da subárvore direita
+                proximo[m++] = nivel[i]->esquerda;
             }
-            if (current->esquerda != NULL)
+            if (nivel[i]->direita != NULL)
             {
-                predecessor = EncontrarMaxNode(current->esquerda); // Encontra o nó máximo da subárvore esquerda
+                proximo[m++] = nivel[i]->direita;
             }
-            break;
+            free(nivel[i]);
+            liberados++;
         }
-    }
 
-    // Imprime o sucessor, se existir
-    if (successor != NULL)
-    {
-        printf("Sucessor de %d: %d\n", x, successor->elemento);
+        AvlNode **troca = nivel;
+        nivel = proximo;
+        proximo = troca;
+        n = m;
     }
-    else
+    atomic_fetch_add(&d->liberados, liberados);
+
+    d->subarvores = nivel;
+    d->quantidade = n;
+    for (i = 1; i < d->num_threads; i++)
     {
-        printf("Não há sucessor para %d\n", x);
+        pthread_create(&threads[i], NULL, liberarSubarvoresThread, (void *)d);
     }
 
-    // Imprime o predecessor, se existir
-    if (predecessor != NULL)
+    // A coordenadora também libera subárvores
+    while ((i = atomic_fetch_add(&d->proxima, 1)) < d->quantidade)
     {
-        printf("Predecessor de %d: %d\n", x, predecessor->elemento);
+        atomic_fetch_add(&d->liberados, liberarSubarvore(d->subarvores[i]));
     }
-    else
+
+    for (i = 1; i < d->num_threads; i++)
     {
-        printf("Não há predecessor para %d\n", x);
+        pthread_join(threads[i], NULL);
     }
+
+    free(nivel);
+    free(proximo);
+    pthread_exit(NULL);
 }
 
-/
-    *Imprime o elemento mínimo e máximo de uma árvore AVL.
-         *
-             *@param t O ponteiro para o nó raiz da árvore.
-                 * /
-    void printMinMax(AvlNode *t)
+/*
+ * Desliga a árvore da sua raiz e inicia a liberação dos nós em segundo plano.
+ * A raiz passa a ser NULL imediatamente, então o chamador pode atribuir uma nova árvore a ela
+ * logo em seguida, enquanto a antiga é liberada fora do caminho crítico.
+ * Com um WAL aberto, a limpeza é registrada e sincronizada antes do retorno, para que a
+ * recuperação não traga de volta os elementos descartados. Liberar a árvore sem WAL (por exemplo,
+ * depois de walFechar) apenas devolve a memória e não altera o estado persistido.
+ * Deve ser chamada com o mutex da árvore adquirido ou sem threads de atualização ativas.
+ *
+ * @param t O endereço da raiz da árvore.
+ * @param versao O contador de versão da árvore, incrementado para invalidar os dedos, ou NULL.
+ * @param cache O cache de chaves quentes da árvore, que é esvaziado, ou NULL.
+ * @param wal O WAL da árvore, onde a limpeza é registrada, ou NULL.
+ * @param num_threads A quantidade de threads usadas na liberação.
+ * @return O estado da destruição, a ser passado para aguardarDestruicao.
+ */
+DestruicaoArvore *destruirArvoreAssincrona(AvlNode **t, unsigned long *versao, CacheVizinhos *cache, Wal *wal, int num_threads)
 {
-    AvlNode *minNode = EncontrarMinNode(t); // Encontra o nó mínimo da árvore
-    AvlNode *maxNode = EncontrarMaxNode(t); // Encontra o nó máximo da árvore
+    DestruicaoArvore *d = (DestruicaoArvore *)calloc(1, sizeof(DestruicaoArvore));
 
-    // Imprime o elemento mínimo, se existir
-    if (minNode != NULL)
+    if (d == NULL)
     {
-        printf("Elemento mínimo: %d\n", minNode->elemento);
+        printf("Erro ao alocar memória\n");
+        exit(1);
     }
-    else
+
+    d->raiz = *t;
+    d->num_threads = num_threads > 0 ? num_threads : 1;
+    atomic_init(&d->proxima, 0);
+    atomic_init(&d->liberados, 0);
+
+    // Desliga a árvore antes de liberá-la, invalidando os dedos e o cache que apontam para ela
+    *t = NULL;
+    if (versao != NULL)
     {
-        printf("A árvore está vazia. Não há elemento mínimo.\n");
+        (*versao)++;
     }
-
-    // Imprime o elemento máximo, se existir
-    if (maxNode != NULL)
+    if (cache != NULL)
     {
-        printf("Elemento máximo: %d\n", maxNode->elemento);
+        cacheLimpar(cache);
     }
-    else
+    if (wal != NULL)
     {
-        printf("A árvore está vazia. Não há elemento máximo.\n");
+        walRegistrar(wal, 0, WAL_OP_LIMPAR, 0);
+        walSincronizar(wal);
     }
+
+    pthread_create(&d->coordenador, NULL, coordenarDestruicaoThread, (void *)d);
+    return d;
 }
 
-/
-    *Função executada por uma thread para remover elementos de uma árvore AVL.
-         *
-             *@param arg O argumento passado para a thread,
-    que contém os dados da thread.
-            *@ return Nenhum valor de retorno.*
-        /
-        void * removerThread(void *arg)
+/*
+ * Aguarda o fim de uma destruição iniciada por destruirArvoreAssincrona e libera o seu estado.
+ *
+ * @param d O estado da destruição.
+ * @return A quantidade de nós liberados.
+ */
+long long aguardarDestruicao(DestruicaoArvore *d)
 {
-    ThreadData *data = (ThreadData *)arg; // Obtém os dados da thread
-    AvlNode arvore = data->arvore;        // Ponteiro para a árvore
-    int inicio = data->inicio;            // Índice de início
-    int fim = data->fim;                  // Índice de fim
-    pthread_mutex_t *mutex = data->mutex; // Ponteiro para o mutex
-
-    for (int i = inicio; i <= fim; i++)
-    {
-        int valor = rand() % (NUM_ELEMENTOS_ARVORE_PARA_REMOVER * 10); // Gera um valor aleatório para remover
-        int removerElemento = -1;
+    long long liberados;
 
-        pthread_mutex_lock(mutex); // Lock do mutex antes da remoção
-        removerNode(valor, arvore, &removerElemento);
-        pthread_mutex_unlock(mutex); // Unlock do mutex após a remoção
+    pthread_join(d->coordenador, NULL);
+    liberados = atomic_load(&d->liberados);
+    free(d);
 
-        if (removerElemento != -1)
-        {
-            printf("Elemento removido: %d\n", removerElemento);
-        }
-        // else {
-        // printf("Elemento não encontrado: %d\n", valor);
-        //}
-    }
+    return liberados;
+}
 
-    pthread_exit(NULL);
+/*
+ * Libera todos os nós da árvore em paralelo e deixa a raiz vazia.
+ * Com um WAL aberto, a limpeza é registrada como em destruirArvoreAssincrona.
+ * Deve ser chamada com o mutex da árvore adquirido ou sem threads de atualização ativas.
+ *
+ * @param t O endereço da raiz da árvore.
+ * @param versao O contador de versão da árvore, incrementado para invalidar os dedos, ou NULL.
+ * @param cache O cache de chaves quentes da árvore, que é esvaziado, ou NULL.
+ * @param wal O WAL da árvore, onde a limpeza é registrada, ou NULL.
+ * @param num_threads A quantidade de threads usadas na liberação.
+ * @return A quantidade de nós liberados.
+ */
+long long limparArvore(AvlNode **t, unsigned long *versao, CacheVizinhos *cache, Wal *wal, int num_threads)
+{
+    return aguardarDestruicao(destruirArvoreAssincrona(t, versao, cache, wal, num_threads));
 }
 
 /
@@ -622,7 +2965,7 @@ int altura(AvlNode *t)
          *
              *@ return 0 valor indicando o status de saída do programa.*
     /
-    int main()
+    int main(int argc, char *argv[])
 {
 
     // Declaração das variáveis para medição do tempo
@@ -641,6 +2984,12 @@ int altura(AvlNode *t)
     // Cria a raiz da árvore AVL
     AvlNode *raiz = NULL;
 
+    // Contador de versão da árvore, incrementado a cada modificação para invalidar os dedos das threads
+    unsigned long versao = 0;
+
+    // Cache de chaves quentes para consultas de sucessor e predecessor, quando habilitado
+    CacheVizinhos *cache = CACHE_HABILITADO ? cacheCriar(CACHE_CONJUNTOS) : NULL;
+
     // Cria um array de threads
     pthread_t threads[NUM_THREADS];
 
@@ -657,26 +3006,52 @@ int altura(AvlNode *t)
     // Inicializa o gerador de n?meros aleat?rios
     srand(time(NULL));
 
-    // Cria as threads para inserção paralela
-    for (i = 0; i < NUM_THREADS; i++)
+    // Destruição em segundo plano da árvore usada apenas na medição do WAL
+    DestruicaoArvore *destruicao_memoria = NULL;
+
+    // Recupera a árvore do disco e abre o WAL, quando habilitado
+    Wal *wal = NULL;
+    if (WAL_HABILITADO)
     {
-        // Define o intervalo de elementos para a thread
-        int inicio = i * elementos_por_thread;
-        int fim = inicio + elementos_por_thread - 1;
+        long long reaplicadas = walRecuperar(&raiz, WAL_CAMINHO_LOG, WAL_CAMINHO_SNAPSHOT);
+        printf("WAL: %lld operações reaplicadas a partir do log\n", reaplicadas);
+        wal = walAbrir(WAL_CAMINHO_LOG, NUM_THREADS, WAL_TAMANHO_LOTE, WAL_LATENCIA_COMMIT_US);
+    }
 
-        // Define os dados da thread
-        thread_data[i].arvore = &raiz;
-        thread_data[i].inicio = inicio;
-        thread_data[i].fim = fim;
-        thread_data[i].mutex = &mutex;
+    // O arquivo de chaves pode ser informado como argumento do programa
+    if (argc > 1)
+    {
+        INGESTAO_ARQUIVO = argv[1];
+    }
 
-        // Cria a thread
-        pthread_create(&threads[i], NULL, inserirThread, (void *)&thread_data[i]);
+    if (INGESTAO_ARQUIVO != NULL)
+    {
+        // Popula a árvore a partir do arquivo ou da entrada padrão
+        ingerirArquivo(&raiz, &mutex, &versao, cache, wal, INGESTAO_ARQUIVO);
     }
-    // Aguarda as threads terminarem
-    for (i = 0; i < NUM_THREADS; i++)
+    // Com o WAL habilitado, mede também a mesma carga apenas em memória para comparar o custo da durabilidade
+    else if (wal != NULL)
     {
-        pthread_join(threads[i], NULL);
+        AvlNode *raiz_memoria = NULL;
+        unsigned long versao_memoria = 0;
+        double operacoes = (double)elementos_por_thread * NUM_THREADS;
+        double tempo_memoria = popularArvoreParalela(&raiz_memoria, &mutex, &versao_memoria, NULL, NULL);
+        double tempo_duravel = popularArvoreParalela(&raiz, &mutex, &versao, cache, wal);
+        double ops_memoria = operacoes / tempo_memoria;
+        double ops_duravel = operacoes / tempo_duravel;
+
+        printf("Inserções em memória: %.0f ops/s\n", ops_memoria);
+        printf("Inserções duráveis (WAL): %.0f ops/s\n", ops_duravel);
+        printf("Custo da durabilidade: %.1f%% (%lld registros em %lld commits)\n",
+               (1.0 - ops_duravel / ops_memoria) * 100.0, wal->total_registros, wal->total_lotes);
+
+        // A árvore em memória não é mais usada e é liberada fora do caminho crítico
+        destruicao_memoria = destruirArvoreAssincrona(&raiz_memoria, &versao_memoria, NULL, NULL, NUM_THREADS);
+    }
+    else
+    {
+        // Cria as threads para inserção paralela
+        popularArvoreParalela(&raiz, &mutex, &versao, cache, NULL);
     }
 
     // Imprime a árvore em ordem crescente
@@ -706,6 +3081,10 @@ int altura(AvlNode *t)
         thread_data[i].inicio = inicio;
         thread_data[i].fim = fim;
         thread_data[i].mutex = &mutex;
+        thread_data[i].wal = wal;
+        thread_data[i].id = i;
+        thread_data[i].versao = &versao;
+        thread_data[i].cache = cache;
 
         // Cria a thread
         pthread_create(&threads[i], NULL, removerThread, (void *)&thread_data[i]);
@@ -732,7 +3111,7 @@ int altura(AvlNode *t)
 
         printf("\n");
         // Encontra e imprimi o sucessor e o predecessor do valor aleatório na árvore AVL
-        printSucessorEPredecessor(valor, raiz);
+        printSucessorEPredecessor(valor, raiz, cache);
         printf("\n");
     }
 
@@ -741,12 +3120,58 @@ int altura(AvlNode *t)
     printMinMax(raiz);
     printf("\n");
 
+    // Mede consultas concentradas em poucas chaves, feitas por várias threads ao mesmo tempo
+    if (cache != NULL)
+    {
+        double inicio_consultas = tempoAtual();
+
+        for (i = 0; i < NUM_THREADS; i++)
+        {
+            thread_data[i].arvore = &raiz;
+            thread_data[i].inicio = 0;
+            thread_data[i].fim = CACHE_CONSULTAS - 1;
+            thread_data[i].mutex = &mutex;
+            thread_data[i].id = i;
+            thread_data[i].cache = cache;
+            pthread_create(&threads[i], NULL, consultarThread, (void *)&thread_data[i]);
+        }
+        for (i = 0; i < NUM_THREADS; i++)
+        {
+            pthread_join(threads[i], NULL);
+        }
+
+        printf("Consultas de vizinhos: %.0f consultas/s\n",
+               (double)CACHE_CONSULTAS * NUM_THREADS / (tempoAtual() - inicio_consultas));
+        printEstatisticasCache(cache);
+        printf("\n");
+    }
+
+    // Grava o snapshot da árvore, trunca o log e encerra o WAL
+    if (wal != NULL)
+    {
+        walCheckpoint(wal, raiz, WAL_CAMINHO_SNAPSHOT);
+        walFechar(wal);
+    }
+
+    // Libera a memória da árvore AVL em paralelo. O WAL já foi fechado, então a árvore persistida
+    // no snapshot é preservada para a próxima execução
+    double inicio_liberacao = tempoAtual();
+    long long liberados = limparArvore(&raiz, &versao, cache, NULL, NUM_THREADS);
+    if (destruicao_memoria != NULL)
+    {
+        liberados += aguardarDestruicao(destruicao_memoria);
+    }
+    printf("Árvore liberada: %lld nós em %f segundos\n", liberados, tempoAtual() - inicio_liberacao);
+
+    // Libera o cache de chaves quentes
+    if (cache != NULL)
+    {
+        cacheDestruir(cache);
+    }
+
     // Libera o mutex
     pthread_mutex_destroy(&mutex);
 
-    // Atribui NULL à raiz para liberar a memória da árvore AVL.
-    raiz = NULL;
-
     // Finaliza o tempo e calcula o tempo total
     // O tempo total de execução é calculado pela diferença entre o tempo final e o tempo inicial,
     // dividido pelo valor da constante CLOCKS_PER_SEC, que representa o número de clock ticks por segundo.